@@ -1,44 +1,74 @@
 #include "App.hpp"
 #include "app/Config.hpp"
 #include "platform/Keys.hpp"
+#include "game/LevelPack.hpp"
+#include <cstring>
 
 namespace gv {
 
+namespace {
+// Levels that fit are loaded whole, so the frame loop never waits on the card.
+uint8_t s_levelArena[kLevelArenaBytes];
+
+// One open file and an in-RAM index for every level; loose files are the fallback.
+LevelPack s_levelPack;
+bool s_havePack = false;
+
+const char* const kLevels[] = {
+    "levels/L01.BIN",
+    "levels/L02.BIN",
+};
+
+// Play starts here and carries on through the playlist from it.
+const char* const kStartLevel = "levels/L02.BIN";
+} // anon
+
 int App::run(IPlatform& platform) {
+    start(platform);
+
+    while (true) frame();
+
+    return 0;
+}
+
+void App::start(IPlatform& platform) {
     plat = &platform;
 
     plat->init();
     (void)plat->fs().init();
 
     init(*plat, plat->display().width(), plat->display().height());
+}
 
-    while (true) {
-        uint32_t dt = plat->dtUs();
+void App::frame() {
+    uint32_t dt = plat->dtUs();
 
-        // InputState mapping lives at the app layer now.
-        plat->input().update();
-        const IInput& kb = plat->input();
+    // InputState mapping lives at the app layer now.
+    plat->input().update();
+    const IInput& kb = plat->input();
 
-        InputState in{};
-        in.thrust        = kb.down(KEY_SPACE);
-        in.thrustPressed = kb.pressed(KEY_SPACE);
+    InputState in{};
+    in.thrust        = kb.down(KEY_SPACE);
+    in.thrustPressed = kb.pressed(KEY_SPACE);
 
-        in.up    = kb.down(KEY_UP);
-        in.down  = kb.down(KEY_DOWN);
-        in.left  = kb.down(KEY_LEFT);
-        in.right = kb.down(KEY_RIGHT);
+    in.up    = kb.down(KEY_UP);
+    in.down  = kb.down(KEY_DOWN);
+    in.left  = kb.down(KEY_LEFT);
+    in.right = kb.down(KEY_RIGHT);
 
-        in.confirm = kb.pressed(KEY_ENTER) || kb.pressed(KEY_RETURN);
-        in.back    = kb.pressed(KEY_ESC)   || kb.pressed(KEY_BACKSPACE);
-        in.pausePressed = kb.pressed(KEY_ESC) || kb.pressed(KEY_F1) || kb.pressed(KEY_POWER);
+    in.confirm = kb.pressed(KEY_ENTER) || kb.pressed(KEY_RETURN);
+    in.back    = kb.pressed(KEY_ESC)   || kb.pressed(KEY_BACKSPACE);
+    in.pausePressed = kb.pressed(KEY_ESC) || kb.pressed(KEY_F1) || kb.pressed(KEY_POWER);
 
-        plat->display().beginFrame();
-        tick(in, dt);
-        plat->display().drawLines(drawList());
-        plat->display().endFrame();
-    }
+    // Render option, not game input: toggles hidden-edge mode.
+    if (kb.pressed(KEY_F2)) renderer.setHiddenEdges(!renderer.hiddenEdges());
 
-    return 0;
+    plat->display().beginFrame();
+    tick(in, dt);
+    plat->display().drawLines(drawList());
+    plat->display().endFrame();
+
+    pumpStorage();
 }
 
 void App::init(IPlatform& platform, int screenW, int screenH) {
@@ -46,9 +76,15 @@ void App::init(IPlatform& platform, int screenW, int screenH) {
     h = screenH;
 
     game.reset();
-    game.setFileSystem(&platform.fs());
+    s_havePack = s_levelPack.open(platform.fs(), "levels/LEVELS.PAK");
+    if (s_havePack)
+        game.setFileSystem(&s_levelPack);
+    else
+        game.setFileSystem(&platform.fs());
+    game.setLevelArena(s_levelArena, sizeof(s_levelArena));
 
-    (void)game.loadLevel("levels/L02.BIN");
+    level = startLevel();
+    (void)game.loadLevel(levelPath(level), LevelResidency::Resident);
 
     Camera cam{};
     cam.focal = kDefaultFocal;
@@ -66,6 +102,12 @@ void App::tick(const InputState& in, uint32_t dtUs) {
     fx dt = fx::fromMicros(dtUs);
     game.update(in, dt);
 
+    // The fly-out is seconds of animation: load the next level under it, a slice per frame.
+    if (game.state() == RunState::FinishedFlyOut) {
+        if (game.finishedScroll()) advanceLevel();
+        else pumpPreload();
+    }
+
     Camera cam = renderer.camera();
 
     const fx yOff = game.ship().y * kCameraFollow;
@@ -85,4 +127,81 @@ void App::tick(const InputState& in, uint32_t dtUs) {
     renderer.buildScene(dl, game, game.scrollX());
 }
 
+int App::levelCount() const {
+    return s_havePack ? s_levelPack.levelCount() : int(sizeof(kLevels) / sizeof(kLevels[0]));
+}
+
+const char* App::levelPath(int i) const {
+    return s_havePack ? s_levelPack.levelName(i) : kLevels[i];
+}
+
+int App::startLevel() const {
+    if (s_havePack) {
+        const int i = s_levelPack.findLevel(kStartLevel);
+        return (i >= 0) ? i : 0;
+    }
+    for (int i = 0; i < levelCount(); ++i) {
+        if (std::strcmp(kLevels[i], kStartLevel) == 0) return i;
+    }
+    return 0;
+}
+
+void App::pumpPreload() {
+    if (!preloading) {
+        const int next = (level + 1) % levelCount();
+        preloading = game.beginPreload(levelPath(next), LevelResidency::Resident);
+        if (!preloading) return;
+    }
+
+    // Stop before any step, the first included, that would overrun the budget. The step
+    // estimate jumps to any slower step and decays back after it. An estimate larger than the
+    // whole budget also decays on the frames it blocks, so one slow step cannot stall the
+    // preload for good; whatever is left by the end of the fly-out, commitPreload() finishes.
+    const uint64_t t0 = plat->nowUs();
+    if (preloadStepUs > kPreloadBudgetUs) {
+        preloadStepUs -= preloadStepUs / 4;
+        return;
+    }
+    while (plat->nowUs() - t0 + preloadStepUs <= kPreloadBudgetUs) {
+        const uint64_t s0 = plat->nowUs();
+        if (!game.preloadStep()) break;
+
+        const uint32_t took = uint32_t(plat->nowUs() - s0);
+        preloadStepUs -= preloadStepUs / 4;
+        if (took > preloadStepUs) preloadStepUs = took;
+    }
+}
+
+void App::pumpStorage() {
+    const uint64_t now = plat->nowUs();
+
+    // A removal the card-detect interrupt flagged is torn down here, between frames.
+    plat->fs().checkMedia();
+
+    // The detect switch is a pin read; everything else waits for the card to come back.
+    if (!plat->fs().mediaPresent()) {
+        storageLost = true;
+        storageSeenUs = now;
+        return;
+    }
+    if (!storageLost && !game.levelOffline()) return;
+    if (now - storageSeenUs < kRemountSettleUs) return;
+
+    // Re-initialising the card costs far more than a frame's I/O budget, so it only runs here,
+    // once per settle period. The pack and level keep their headers; only files are reopened.
+    storageSeenUs = now;
+    IFileSystem& fs = s_havePack ? static_cast<IFileSystem&>(s_levelPack) : plat->fs();
+    if (fs.remount() && game.reconnect()) storageLost = false;
+}
+
+void App::advanceLevel() {
+    const int next = (level + 1) % levelCount();
+
+    // A preload the fly-out fully covered switches without I/O; otherwise this finishes it.
+    // If it failed, a cold load retries; a level that still won't load is skipped next frame.
+    if (!preloading || !game.commitPreload()) (void)game.loadLevel(levelPath(next), LevelResidency::Resident);
+    level = next;
+    preloading = false;
+}
+
 } // namespace gv
\ No newline at end of file
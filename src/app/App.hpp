@@ -10,10 +10,23 @@ class App {
 public:
     int run(IPlatform& platform);
 
+    // run() is start() and then frame() forever; host tests drive the two directly.
+    void start(IPlatform& platform);
+    void frame();   // input, game tick, draw, then storage housekeeping
+
 private:
     void init(IPlatform& platform, int screenW, int screenH);
     void tick(const InputState& in, uint32_t dtUs);
 
+    // Level playlist: the pack's order when a pack is present, else the built-in list.
+    int levelCount() const;
+    const char* levelPath(int i) const;
+    int startLevel() const;
+    void advanceLevel();
+    void pumpPreload();
+    // Card removal and return, checked between frames (see Game::levelOffline()).
+    void pumpStorage();
+
     const DrawList& drawList() const { return dl; }
 
 private:
@@ -22,6 +35,13 @@ private:
     Renderer renderer;
     DrawList dl;
     int w{}, h{};
+
+    int level = 0;
+    bool preloading = false;
+    uint32_t preloadStepUs = 0;   // expected cost of the next preload step; it only starts if it fits
+
+    bool storageLost = false;     // the card was out at some point; files need a remount
+    uint64_t storageSeenUs = 0;   // last time the card was seen missing (or a remount failed)
 };
 
 } // namespace gv
\ No newline at end of file
@@ -19,9 +19,21 @@ constexpr fx kFlyOutCells      = fx::fromInt(16 * kCellSize);
 constexpr fx kCameraFollow     = fx::fromRatio(3, 20); // 0.15
 
 // ---- Renderer tuning ----
-constexpr int kColsVisible     = 64;
+constexpr int kColsVisible     = 64;  // streamed window; buildScene draws only what the frustum reaches.
 constexpr int kColsPadLeft     = 6;
 constexpr int kColsPadCells    = 2;   // pad visible X span by this many cells.
+constexpr bool kMergeSquares   = true;  // draw runs of Square cells as single boxes (outer edges only).
+constexpr bool kSquareGridTicks = false; // mark the cell grid on merged boxes with short ticks.
+constexpr bool kHiddenEdges    = false; // start in hidden-edge mode when true (F2 toggles it).
+
+// ---- Level streaming ----
+constexpr int kColsPrefetch    = 16;  // columns per fetch; also the largest GVL2 block.
+// One fetch in flight past the visible span, plus a fetch of slack for block alignment.
+constexpr int kColCacheCols    = kColsVisible + 2 * kColsPrefetch;
+constexpr int kLevelArenaBytes  = 8 * 1024; // RAM budget for a resident level (7 bytes/column).
+constexpr uint32_t kPreloadBudgetUs = 2000;  // per-frame I/O time for loading the next level during fly-out.
+constexpr uint32_t kRemountSettleUs = 250000;  // card-detect must hold this long before a remount.
+constexpr int kLevelReadAheadBytes = 1024;   // forward read-ahead window asked of the level file (two sectors).
 
 // ---- Default camera ----
 constexpr fx kDefaultFocal = fx::fromInt(180);
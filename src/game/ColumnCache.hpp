@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include "app/Config.hpp"
+#include "game/Level.hpp"
+
+namespace gv {
+
+// Fixed-size ring of decoded level columns keyed by column index.
+// Column i lives in slot (i % kSlots); the slot tag says which column is actually there,
+// so a lookup is one modulo + one compare and never touches storage.
+class ColumnCache {
+public:
+    static constexpr int kSlots = kColCacheCols;
+
+    ColumnCache() { clear(); }
+
+    void clear() {
+        for (int i = 0; i < kSlots; ++i) tag_[i] = kNoColumn;
+    }
+
+    const ColumnCells* find(uint16_t col) const {
+        const int s = col % kSlots;
+        return (tag_[s] == col) ? &cols_[s] : nullptr;
+    }
+
+    void put(uint16_t col, const Column56& c) {
+        const int s = col % kSlots;
+        cols_[s] = ColumnCells::decode(c);
+        tag_[s]  = col;
+    }
+
+private:
+    static constexpr uint16_t kNoColumn = 0xFFFF;
+
+    ColumnCells cols_[kSlots]{};
+    uint16_t tag_[kSlots];
+};
+
+} // namespace gv
@@ -2,6 +2,7 @@
 #include "app/Config.hpp"
 #include "game/Playfield.hpp"
 #include "game/LevelMath.hpp"
+#include <bit>
 #include <cstring>
 
 namespace {
@@ -18,10 +19,10 @@ namespace gv {
 bool Game::checkPortalReached(fx shipY) const {
     if (!hasLevel()) return false;
 
-    const int width = int(levelHdr.width);
+    const int width = int(levelHeader().width);
     if (width <= 0) return false;
 
-    const int portalX = (width - 1) + int(levelHdr.portalDx);
+    const int portalX = (width - 1) + int(levelHeader().portalDx);
     if (portalX < 0 || portalX >= width) return false;
 
     // Treat ship level-space X as xScroll (ship is fixed on screen).
@@ -32,7 +33,7 @@ bool Game::checkPortalReached(fx shipY) const {
     // Convert shipY (world) to row index 0..8 using shared playfield mapping.
     int shipRow = rowFromWorldY(shipY);
 
-    const int py = clampi(int(levelHdr.portalY), 0, kLevelHeight - 1);
+    const int py = clampi(int(levelHeader().portalY), 0, kLevelHeight - 1);
 
     // Accept portalY and one cell above/below.
     return (shipRow >= py - 1) && (shipRow <= py + 1);
@@ -49,27 +50,21 @@ void Game::reset() {
     xScroll  = fx::zero();
     finished_ = false;
 
+    cancelPreload();
     unloadLevel();
 }
 
-bool Game::loadLevel(const char* path) {
+bool Game::loadLevel(const char* path, LevelResidency policy) {
+    cancelPreload();
     unloadLevel();
 
-    if (!fs_) return false;
-
-    file_ = fs_->openRead(path);
-    if (!file_) return false;
-
-    size_t got = 0;
-    if (!file_->seek(0)) { unloadLevel(); return false; }
-    if (!file_->read(&levelHdr, sizeof(LevelHeaderV1), got) || got != sizeof(LevelHeaderV1)) {
-        unloadLevel();
-        return false;
-    }
+    // The same path as a preload, with every step run back to back.
+    if (!beginPreload(path, policy)) return false;
+    return commitPreload();
+}
 
-    if (std::memcmp(levelHdr.magic, "GVL1", 4) != 0) { unloadLevel(); return false; }
-    if (levelHdr.version != 1) { unloadLevel(); return false; }
-    if (levelHdr.height != kLevelHeight) { unloadLevel(); return false; }
+void Game::startLevel() {
+    const LevelHeaderV1& hdr = levelHeader();
 
     finished_ = false;
     hit = false;
@@ -78,9 +73,9 @@ bool Game::loadLevel(const char* path) {
     runState = RunState::WaitingToStart;
 
     // ---- spawn from header (cell coords) ----
-    const int h = int(levelHdr.height);
-    const int startY = (h > 0) ? clampi(int(levelHdr.startY), 0, h - 1) : 0;
-    const int startX = clampi(int(levelHdr.startX), 0, int(levelHdr.width) - 1);
+    const int h = int(hdr.height);
+    const int startY = (h > 0) ? clampi(int(hdr.startY), 0, h - 1) : 0;
+    const int startX = clampi(int(hdr.startX), 0, int(hdr.width) - 1);
 
     // Place the ship at the center of the start cell in Y.
     const fx rowY0 = worldYForRow(startY);
@@ -88,28 +83,269 @@ bool Game::loadLevel(const char* path) {
 
     // Start the scroll so the startX column is under the ship.
     xScroll = fx::fromInt(startX * kCellSize);
+}
+
+void Game::unloadLevel() {
+    waitPrefetch();
+    level_.close();
+    offline_ = false;
+
+    resident_ = nullptr;
+    cols_.clear();
+    streamHi_ = 0;
+}
+
+bool Game::beginPreload(const char* path, LevelResidency policy) {
+    cancelPreload();
+    if (!fs_ || !path) return false;
 
+    nextPath_ = path;
+    nextPolicy_ = policy;
+    preload_ = PreloadStage::Open;
     return true;
 }
 
-void Game::unloadLevel() {
-    if (file_) {
-        file_->close();
-        file_ = nullptr;
+void Game::cancelPreload() {
+    next_.close();
+    preload_ = PreloadStage::Idle;
+}
+
+bool Game::preloadStep() {
+    if (preload_ == PreloadStage::Open) {
+        if (!next_.open(*fs_, nextPath_)) {
+            preload_ = PreloadStage::Failed;
+            return false;
+        }
+
+        // A level that fits the arena is read once and never touches the card again.
+        // If the arena is missing or too small, keep streaming instead.
+        const int width = int(next_.header().width);
+        if (nextPolicy_ == LevelResidency::Resident && arena_ && size_t(width) <= arenaCols_) {
+            nextResident_ = true;
+            nextLo_ = nextHi_ = 0;
+            nextEnd_ = width;
+            preload_ = (width > 0) ? PreloadStage::Columns : PreloadStage::Ready;
+        } else {
+            stageFirstScreen();
+        }
+        return true;
+    }
+
+    if (preload_ != PreloadStage::Columns) return false;
+
+    // The arena is still feeding the current level's window; wait until it has it all.
+    if (nextResident_ && arenaBusy()) return false;
+
+    Column56* dst = nextResident_ ? arena_ + nextHi_ : nextCols_ + (nextHi_ - nextLo_);
+    uint8_t buf[LevelSource::kUnitBytes];   // stage_ may hold the current level's prefetch
+    if (!next_.readUnit(nextHi_, buf, dst)) {
+        // A failed resident load can still stream; a failed first screen cannot start.
+        if (nextResident_) {
+            stageFirstScreen();
+            return true;
+        }
+        preload_ = PreloadStage::Failed;
+        return false;
+    }
+
+    nextHi_ += next_.unitCount(nextHi_);
+    if (nextHi_ >= nextEnd_) preload_ = PreloadStage::Ready;
+    return true;
+}
+
+void Game::stageFirstScreen() {
+    // The window startLevel() + streamColumns() open on: stage its visible columns.
+    const int width = int(next_.header().width);
+    const int startX = clampi(int(next_.header().startX), 0, width - 1);
+    int lo = startX - kColsPadLeft;
+    if (lo < 0) lo = 0;
+
+    nextResident_ = false;
+    nextLo_ = nextHi_ = lo - lo % next_.unitCols();
+    nextEnd_ = (lo + kColsVisible < width) ? lo + kColsVisible : width;
+    preload_ = (nextHi_ < nextEnd_) ? PreloadStage::Columns : PreloadStage::Ready;
+}
+
+bool Game::commitPreload() {
+    if (preload_ == PreloadStage::Idle) return false;
+
+    unloadLevel();
+
+    // Finish whatever the caller did not step through. A resident level reads its
+    // remaining columns in one go; nothing here runs once the preload is Ready.
+    if (preload_ == PreloadStage::Open) preloadStep();
+    if (preload_ == PreloadStage::Columns && nextResident_) {
+        uint8_t buf[LevelSource::kUnitBytes];
+        if (next_.readColumns(nextHi_, nextEnd_, buf, arena_ + nextHi_)) {
+            nextHi_ = nextEnd_;
+            preload_ = PreloadStage::Ready;
+        } else {
+            stageFirstScreen();
+        }
+    }
+    while (preload_ == PreloadStage::Columns) preloadStep();
+
+    if (preload_ != PreloadStage::Ready) {
+        cancelPreload();
+        return false;
+    }
+
+    level_ = next_;
+    next_ = LevelSource{};       // the file moved to level_
+    preload_ = PreloadStage::Idle;
+
+    if (nextResident_) {
+        resident_ = arena_;
+        level_.closeFile();
+    }
+
+    startLevel();
+
+    if (!resident_) {
+        // Hand the staged first screen to the cache so streamColumns() has nothing to read.
+        int lo = xScroll.toInt() / kCellSize - kColsPadLeft;
+        if (lo < 0) lo = 0;
+        winLo_ = lo;
+        for (int c = nextLo_; c < nextHi_; c += level_.unitCols()) storeUnit(c, nextCols_ + (c - nextLo_));
+    }
+
+    streamColumns();
+
+    return true;
+}
+
+void Game::storeUnit(int first, const Column56* cols) {
+    const int count = level_.unitCount(first);
+
+    // Columns behind the window would evict live slots; they are never needed again anyway.
+    for (int i = 0; i < count; ++i) {
+        if (first + i >= winLo_) cols_.put((uint16_t)(first + i), cols[i]);
     }
-    std::memset(&levelHdr, 0, sizeof(levelHdr));
+    if (first + count > streamHi_) streamHi_ = first + count;
 }
 
-bool Game::readLevelColumn(uint16_t i, Column56& out) const {
-    if (!file_) return false;
-    if (i >= levelHdr.width) return false;
+void Game::streamColumns() {
+    if (!hasLevel()) return;
+
+    const int width = int(levelHeader().width);
+    const int unit = level_.unitCols();
+
+    // Window matches the renderer's visible span plus room for prefetch ahead of it.
+    int lo = xScroll.toInt() / kCellSize - kColsPadLeft;
+    if (lo < 0) lo = 0;
+    winLo_ = lo;
+
+    if (resident_) {
+        // Everything is in RAM: unpack the columns entering the window, no I/O.
+        int hi = lo + kColCacheCols;
+        if (hi > width) hi = width;
+        if (streamHi_ < lo) streamHi_ = lo;
+        for (; streamHi_ < hi; ++streamHi_) cols_.put((uint16_t)streamHi_, resident_[streamHi_]);
+        return;
+    }
+
+    // No file to read from: play runs on over what is cached, and past it the columns come
+    // back empty until reconnect() refills the window.
+    if (offline_) return;
+
+    int need = lo + kColsVisible;
+    if (need > width) need = width;
 
-    const size_t offset = 16u + size_t(i) * size_t(kColumnBytes);
-    if (!file_->seek(offset)) return false;
+    if (pendCount_ > 0) {
+        size_t got = 0;
+        const IoStatus st = level_.file()->poll(got);
+        pumpPrefetch(st, got);
+    }
+
+    // Scroll only moves forward, so anything below streamHi_ and inside the window is already cached.
+    if (streamHi_ < need && !offline_) {
+        // Prefetch fell behind (or first fill): the visible columns must be here this frame.
+        waitPrefetch();
+        skipBehind(lo);
+
+        Column56 cols[kColsPrefetch];
+        while (streamHi_ < need && !offline_) {
+            if (level_.readUnit(streamHi_, stage_, cols)) storeUnit(streamHi_, cols);
+            else goOffline();
+        }
+    }
+
+    if (offline_) return;
+
+    if (pendCount_ == 0) skipBehind(lo);
+
+    // Fetch the next unit once it fits the cache without evicting anything still visible.
+    if (pendCount_ == 0 && streamHi_ < width && streamHi_ + unit <= lo + kColCacheCols) {
+        startPrefetch(streamHi_);
+    }
+}
+
+void Game::goOffline() {
+    // Keep the file: hasLevel() still holds, and reconnect() swaps it for a fresh one.
+    pendCount_ = 0;
+    offline_ = true;
+}
+
+bool Game::reconnect() {
+    if (!offline_) return true;
+    if (!fs_ || !level_.reopen(*fs_)) return false;
+
+    // The scroll kept going while offline, so the visible columns are read here, off the
+    // frame path; the window then streams on from wherever it is now.
+    offline_ = false;
+    streamColumns();
+    return !offline_;
+}
+
+void Game::skipBehind(int lo) {
+    // Never restart below streamHi_: past the level end the window outruns it for good.
+    const int unitLo = lo - lo % level_.unitCols();
+    if (streamHi_ < unitLo) streamHi_ = unitLo;
+}
+
+void Game::startPrefetch(int first) {
+    size_t offset = 0, bytes = 0;
+    if (!level_.locateUnit(first, offset, bytes) || !level_.file()->seek(offset)) {
+        goOffline();
+        return;
+    }
+
+    pendLo_ = first;
+    pendCount_ = level_.unitCount(first);
+    stageWant_ = bytes;
+    stageGot_ = 0;
 
     size_t got = 0;
-    if (!file_->read(out.b, kColumnBytes, got)) return false;
-    return got == kColumnBytes;
+    const IoStatus st = level_.file()->readAsync(stage_, bytes, got);
+    pumpPrefetch(st, got);
+}
+
+void Game::pumpPrefetch(IoStatus st, size_t got) {
+    // Reads may come back short (sector/cluster edges); keep issuing until the unit is whole.
+    while (pendCount_ > 0 && st != IoStatus::Pending) {
+        if (st == IoStatus::Error || got == 0) {
+            goOffline(); // the unit is fetched again after reconnect()
+            return;
+        }
+
+        stageGot_ += got;
+        if (stageGot_ >= stageWant_) {
+            Column56 cols[kColsPrefetch];
+            if (level_.decodeUnit(pendLo_, stage_, stageWant_, cols)) storeUnit(pendLo_, cols);
+            pendCount_ = 0;
+            return;
+        }
+
+        st = level_.file()->readAsync(stage_ + stageGot_, stageWant_ - stageGot_, got);
+    }
+}
+
+void Game::waitPrefetch() {
+    while (pendCount_ > 0) {
+        size_t got = 0;
+        const IoStatus st = level_.file()->poll(got);
+        pumpPrefetch(st, got);
+    }
 }
 
 void Game::update(const InputState& in, fx dt) {
@@ -133,6 +369,7 @@ void Game::update(const InputState& in, fx dt) {
         // Keep scrolling the world and push the ship forward off-screen.
         xScroll = xScroll + kScrollSpeed * dt;
         flyOutX = flyOutX + kFlyOutSpeed * dt;
+        streamColumns();
 
         if (flyOutX >= kFlyOutCells) {
             finished_ = true;
@@ -151,6 +388,7 @@ void Game::update(const InputState& in, fx dt) {
 
     // Scroll
     xScroll = xScroll + kScrollSpeed * dt;
+    streamColumns();
 
     // Check portal completion before obstacle hit so portal "wins" if both happen together.
     if (checkPortalReached(shipState.y)) {
@@ -185,7 +423,7 @@ bool Game::checkCollisionAt(fx shipY) const {
     if (colA < 0) colA = 0;
     if (colB < 0) colB = 0;
 
-    const int maxCol = int(levelHdr.width) - 1;
+    const int maxCol = int(levelHeader().width) - 1;
     if (colA > maxCol) colA = maxCol;
     if (colB > maxCol) colB = maxCol;
 
@@ -197,17 +435,19 @@ bool Game::checkCollisionAt(fx shipY) const {
     int rowB = rowFromWorldY(yLow);
     if (rowA > rowB) { int t = rowA; rowA = rowB; rowB = t; }
 
-    Column56 col{};
+    // Rows rowA..rowB as a bitmask, intersected with each column's occupancy.
+    const uint16_t rowMask = uint16_t(((1u << (rowB + 1)) - 1u) & ~((1u << rowA) - 1u));
+
     for (int c = colA; c <= colB; ++c) {
-        if (!readLevelColumn((uint16_t)c, col)) continue;
+        const ColumnCells* col = cachedColumn((uint16_t)c);
+        if (!col) continue;
 
         const fx lx = localXInColumn(xScroll, c);
 
-        for (int row = rowA; row <= rowB; ++row) {
-            const ShapeId sid = col.shape(row);
-            if (sid == ShapeId::Empty) continue;
-
-            const ModId mid = col.mod(row);
+        for (uint16_t rows = col->occupied & rowMask; rows; rows &= uint16_t(rows - 1)) {
+            const int row = std::countr_zero(rows);
+            const ShapeId sid = col->shape[row];
+            const ModId mid = col->mod[row];
 
             const fx rowY0 = worldYForRow(row);
             const fx ly = sy - rowY0; // local Y in [0..k] when inside cell
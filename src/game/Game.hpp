@@ -2,7 +2,9 @@
 #include <cstdint>
 #include "render/Fixed.hpp"
 #include "game/Level.hpp"
+#include "game/ColumnCache.hpp"
 #include "game/Input.hpp"
+#include "game/LevelSource.hpp"
 #include "platform/IFileSystem.hpp"
 
 namespace gv {
@@ -12,6 +14,11 @@ struct ShipState {
     fx vy{};
 };
 
+enum class LevelResidency : uint8_t {
+    Streamed,   // columns stream from the file as the window scrolls
+    Resident,   // whole level decoded into the level arena at load; falls back to Streamed if it won't fit
+};
+
 enum class RunState : uint8_t {
     WaitingToStart,
     Running,
@@ -25,14 +32,40 @@ public:
 
     void setFileSystem(IFileSystem* fs) { fs_ = fs; }
 
+    // Caller-owned memory for LevelResidency::Resident; its size is the residency budget.
+    void setLevelArena(void* mem, size_t bytes) {
+        arena_ = static_cast<Column56*>(mem);
+        arenaCols_ = bytes / kColumnBytes;
+    }
+
     // Level I/O
-    bool loadLevel(const char* path);   // opens + reads header
+    bool loadLevel(const char* path, LevelResidency policy = LevelResidency::Streamed);   // opens + reads header
     void unloadLevel();
-    bool hasLevel() const { return file_ != nullptr; }
-    const LevelHeaderV1& levelHeader() const { return levelHdr; }
-
-    // Stream a column (0..width-1). Returns false on error/out of range.
-    bool readLevelColumn(uint16_t i, Column56& out) const;
+    bool hasLevel() const { return level_.isOpen() || resident_ != nullptr; }
+    bool levelResident() const { return resident_ != nullptr; }
+    const LevelHeaderV1& levelHeader() const { return level_.header(); }
+
+    // Next-level preload, paced by the caller. beginPreload() names the level to follow (path
+    // must outlive the preload); each preloadStep() does one bounded piece of I/O - open and
+    // header, then one fetch unit of the first screen (or of the whole level when it goes
+    // resident) - and returns false when there is nothing to do right now. commitPreload()
+    // switches levels, running any steps still left; after preloadReady() it does no I/O.
+    bool beginPreload(const char* path, LevelResidency policy = LevelResidency::Streamed);
+    bool preloadStep();
+    bool preloadReady() const { return preload_ == PreloadStage::Ready; }
+    bool commitPreload();
+    void cancelPreload();
+
+    // A streamed level goes offline when a read fails (e.g. the card was pulled): play keeps
+    // running on the columns already in RAM, and columns past them are empty. reconnect()
+    // reopens the file once storage is back and reads the visible window - blocking, so call
+    // it between frames.
+    bool levelOffline() const { return offline_; }
+    bool reconnect();
+
+    // Cached column lookup for the per-frame path (render/collision); never does I/O.
+    // Returns nullptr if the column is outside the streamed window.
+    const ColumnCells* cachedColumn(uint16_t i) const { return cols_.find(i); }
 
     void update(const InputState& in, fx dt);
 
@@ -53,6 +86,23 @@ private:
     bool checkCollisionAt(fx shipY) const;
     static bool collideCell(ShapeId sid, ModId mid, fx lx, fx ly, fx lz, fx r);
 
+    // Slide the cached column window to follow xScroll; reads only columns that just entered it.
+    // Streaming moves in units that start on a unit boundary: kColsPrefetch raw columns (GVL1)
+    // or one compressed block (GVL2). Visible columns are read synchronously if missing; the
+    // unit ahead is fetched with IFile::readAsync() so the transfer overlaps the rest of the frame.
+    void streamColumns();
+    void startPrefetch(int first);
+    void pumpPrefetch(IoStatus st, size_t got);
+    void waitPrefetch();
+
+    void storeUnit(int first, const Column56* cols);
+    void skipBehind(int lo);
+    void goOffline();
+
+    void startLevel();
+    void stageFirstScreen();
+    bool arenaBusy() const { return resident_ && streamHi_ < int(levelHeader().width); }
+
     ShipState shipState{};
     RunState runState = RunState::WaitingToStart;
     fx xScroll{};
@@ -61,8 +111,37 @@ private:
     bool hit = false;
 
     IFileSystem* fs_ = nullptr;
-    IFile* file_ = nullptr;      // IFileSystem owns the backing file; keep a pointer while open.
-    LevelHeaderV1 levelHdr{};
+    LevelSource level_;
+
+    Column56* arena_ = nullptr;
+    size_t arenaCols_ = 0;
+    const Column56* resident_ = nullptr; // every column of a resident level; the file is closed
+
+    ColumnCache cols_{};
+    int winLo_ = 0;              // first column of the current window
+    int streamHi_ = 0;           // one past the highest column already streamed into cols_
+
+    // In-flight prefetch of the unit at pendLo_ into stage_.
+    uint8_t stage_[LevelSource::kUnitBytes]{};
+    size_t stageWant_ = 0;
+    size_t stageGot_ = 0;
+    int pendLo_ = 0;
+    int pendCount_ = 0;          // 0 = nothing in flight
+    bool offline_ = false;       // the level file failed; stream nothing until reconnect()
+
+    // Preload of the next level. A resident level loads straight into the arena once the
+    // current level no longer reads from it; otherwise the first screen is staged here.
+    enum class PreloadStage : uint8_t { Idle, Open, Columns, Ready, Failed };
+
+    PreloadStage preload_ = PreloadStage::Idle;
+    const char* nextPath_ = nullptr;
+    LevelResidency nextPolicy_ = LevelResidency::Streamed;
+    LevelSource next_;
+    bool nextResident_ = false;
+    int nextLo_ = 0;             // first staged column (starts a unit)
+    int nextHi_ = 0;             // one past the last staged column
+    int nextEnd_ = 0;            // staging is complete once nextHi_ reaches this
+    Column56 nextCols_[kColsVisible + kColsPrefetch]{};
 };
 
 } // namespace gv
\ No newline at end of file
@@ -27,8 +27,8 @@ enum class ModId : uint8_t {
 
 #pragma pack(push, 1)
 struct LevelHeaderV1 {
-    char     magic[4];     // "GVL1"
-    uint8_t  version;      // 1
+    char     magic[4];     // "GVL1" (raw columns) or "GVL2" (compressed blocks)
+    uint8_t  version;      // 1 or 2, matching the magic
     uint16_t width;        // little-endian
     uint8_t  height;       // 9
     uint8_t  startX;
@@ -42,6 +42,10 @@ struct LevelHeaderV1 {
 
 static_assert(sizeof(LevelHeaderV1) == 16, "LevelHeaderV1 must be 16 bytes");
 
+// Widest level accepted: scrolled to its end, the pixel position still fits fx's integer part.
+static constexpr int kMaxLevelWidth = 2048;
+static_assert(kMaxLevelWidth * kCellSize < 32768, "kMaxLevelWidth overflows the scroll position");
+
 // 56-bit column payload stored as 7 bytes LE
 struct Column56 {
     uint8_t b[kColumnBytes];
@@ -74,6 +78,28 @@ struct Column56 {
     }
 };
 
+// Column unpacked once when it is streamed in, so per-frame loops never touch the 56-bit packing.
+// occupied has bit y set for every non-empty row y; walk it with countr_zero to skip empty rows.
+struct ColumnCells {
+    ShapeId  shape[kLevelHeight];
+    ModId    mod[kLevelHeight];
+    uint16_t occupied;
+
+    static ColumnCells decode(const Column56& c) {
+        ColumnCells out{};
+        uint64_t v = c.to_u64();
+        for (int y = 0; y < kLevelHeight; ++y, v >>= 6) {
+            const uint8_t cell = uint8_t(v & 0x3FULL);
+            out.shape[y] = ShapeId(cell & 0x0F);
+            out.mod[y]   = ModId((cell >> 4) & 0x03);
+            if (out.shape[y] != ShapeId::Empty) out.occupied |= uint16_t(1u << y);
+        }
+        return out;
+    }
+};
+
+static_assert(kLevelHeight <= 16, "ColumnCells::occupied holds one bit per row");
+
 inline bool read_header(FILE* f, LevelHeaderV1& out) {
     if (!f) return false;
     if (std::fread(&out, 1, sizeof(LevelHeaderV1), f) != sizeof(LevelHeaderV1)) return false;
@@ -91,6 +117,54 @@ inline bool read_column(FILE* f, uint16_t i, Column56& out) {
     return std::fread(out.b, 1, kColumnBytes, f) == kColumnBytes;
 }
 
+// ---- GVL2: compressed, still seekable ----
+// header(16) | LevelInfoV2 | dict: dictCount x Column56 | blockCount + 1 uint32 LE file offsets
+// (the last is the end of the data) | blocks.
+// Block b holds columns [b << blockShift, (b + 1) << blockShift) as one-byte tokens that never
+// cross a block: bits 7..6 = run - 1 (1..4 columns), bits 5..0 = dict index, or 0x3F for a
+// literal column whose 7 bytes follow the token. Longer runs repeat the token.
+#pragma pack(push, 1)
+struct LevelInfoV2 {
+    uint8_t  blockShift;   // columns per block = 1 << blockShift
+    uint8_t  dictCount;    // <= kMaxLevelDict
+    uint16_t blockCount;   // little-endian, ceil(width / block columns)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(LevelInfoV2) == 4, "LevelInfoV2 must be 4 bytes");
+
+static constexpr uint8_t kLevelLiteral = 0x3F;
+static constexpr int kMaxLevelDict = 63;
+// Block offsets are held in RAM while the level is open: the widest level in fetch-unit blocks.
+static constexpr int kMaxLevelBlocks = kMaxLevelWidth / kColsPrefetch;
+
+// Expand one block into `count` columns. Returns false unless the tokens cover exactly `count`.
+inline bool decode_block_v2(const uint8_t* src, size_t n, const Column56* dict, int dictCount,
+                            Column56* out, int count) {
+    size_t p = 0;
+    int c = 0;
+    while (c < count) {
+        if (p >= n) return false;
+        const uint8_t t = src[p++];
+        const int run = (t >> 6) + 1;
+        const uint8_t idx = t & 0x3F;
+
+        Column56 col;
+        if (idx == kLevelLiteral) {
+            if (p + kColumnBytes > n) return false;
+            std::memcpy(col.b, src + p, kColumnBytes);
+            p += kColumnBytes;
+        } else {
+            if (idx >= dictCount) return false;
+            col = dict[idx];
+        }
+
+        if (c + run > count) return false;
+        for (int i = 0; i < run; ++i) out[c++] = col;
+    }
+    return p == n;
+}
+
 // Portal absolute X is (width-1) + portalDx
 inline int portal_abs_x(const LevelHeaderV1& h) {
     return int(h.width) - 1 + int(h.portalDx);
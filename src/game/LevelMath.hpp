@@ -5,7 +5,7 @@
 namespace gv {
 
 // Apply modifier to a 3D point around an origin (XY rotation/invert, Z preserved).
-static inline void applyMod3(ModId mod, const Vec3fx& origin, Vec3fx& p) {
+static constexpr void applyMod3(ModId mod, const Vec3fx& origin, Vec3fx& p) {
     fx ox = origin.x, oy = origin.y, oz = origin.z;
 
     fx dx = p.x - ox;
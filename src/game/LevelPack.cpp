@@ -0,0 +1,188 @@
+#include "LevelPack.hpp"
+#include <cctype>
+#include <cstring>
+
+namespace gv {
+
+size_t PackFile::clampToPayload(size_t bytes) const {
+    const size_t left = (pos_ < length_) ? size_t(length_) - pos_ : 0;
+    return (bytes < left) ? bytes : left;
+}
+
+bool PackFile::read(void* dst, size_t bytes, size_t& outRead) {
+    outRead = 0;
+    if (!pack_ || !pack_->file_) return false;
+
+    bytes = clampToPayload(bytes);
+    if (bytes == 0) return true; // EOF
+
+    // Every view shares the pack's file, so position it on each access.
+    if (pack_->pending_ == this) return false;
+    pack_->finishPending();
+    IFile* f = pack_->file_;
+    if (!f->seek(offset_ + pos_)) return false;
+    if (!f->read(dst, bytes, outRead)) return false;
+    pos_ += outRead;
+    return true;
+}
+
+bool PackFile::seek(size_t absOffset) {
+    if (!pack_ || absOffset > length_) return false;
+    pos_ = absOffset;
+    return true;
+}
+
+IoStatus PackFile::readAsync(void* dst, size_t bytes, size_t& outRead) {
+    outRead = 0;
+    if (!pack_ || !pack_->file_) return IoStatus::Error;
+
+    if (pack_->pending_ == this || parked_) return IoStatus::Error;
+
+    bytes = clampToPayload(bytes);
+    if (bytes == 0) return IoStatus::Done;
+
+    pack_->finishPending();
+    IFile* f = pack_->file_;
+    if (!f->seek(offset_ + pos_)) return IoStatus::Error;
+
+    const IoStatus st = f->readAsync(dst, bytes, outRead);
+    if (st == IoStatus::Done) pos_ += outRead;
+    if (st == IoStatus::Pending) pack_->pending_ = this;
+    return st;
+}
+
+IoStatus PackFile::poll(size_t& outRead) {
+    outRead = 0;
+    if (parked_) {
+        parked_ = false;
+        outRead = parkedRead_;
+        return parkedStatus_;
+    }
+
+    // Only this view's own request is polled; the file may be busy for another view.
+    if (!pack_ || pack_->pending_ != this) return IoStatus::Done;
+    if (!pack_->file_) return IoStatus::Error;
+
+    const IoStatus st = pack_->file_->poll(outRead);
+    if (st == IoStatus::Pending) return st;
+    pack_->pending_ = nullptr;
+    if (st == IoStatus::Done) pos_ += outRead;
+    return st;
+}
+
+void PackFile::hint(AccessPattern pattern, size_t windowBytes) {
+    if (!pack_ || !pack_->file_) return;
+    pack_->finishPending();
+    pack_->file_->hint(pattern, windowBytes);
+}
+
+void PackFile::close() {
+    // A read still in flight writes into the caller's buffer; let it land before letting go.
+    if (pack_) pack_->finishPending();
+    parked_ = false;
+    pack_ = nullptr;
+}
+
+void LevelPack::finishPending() {
+    PackFile* owner = pending_;
+    if (!owner) return;
+    pending_ = nullptr;
+
+    size_t got = 0;
+    IoStatus st = file_ ? IoStatus::Pending : IoStatus::Error;
+    while (st == IoStatus::Pending) st = file_->poll(got);
+    if (st == IoStatus::Done) owner->pos_ += got;
+
+    owner->parked_ = true;
+    owner->parkedStatus_ = st;
+    owner->parkedRead_ = (st == IoStatus::Done) ? got : 0;
+}
+
+bool LevelPack::open(IFileSystem& backing, const char* path) {
+    close();
+
+    backing_ = &backing;
+    path_ = path;
+    file_ = backing.openPinned(path);
+    if (!file_) return false;
+
+    PackHeaderV1 hdr{};
+    size_t got = 0;
+    if (!file_->read(&hdr, sizeof(hdr), got) || got != sizeof(hdr) ||
+        std::memcmp(hdr.magic, "GVPK", 4) != 0 || hdr.version != 1 || hdr.count > kMaxLevels) {
+        close();
+        return false;
+    }
+
+    // The whole TOC in one read; headers for a level list come from here.
+    const size_t tocBytes = size_t(hdr.count) * sizeof(PackEntryV1);
+    if (!file_->seek(hdr.tocOffset) || !file_->read(toc_, tocBytes, got) || got != tocBytes) {
+        close();
+        return false;
+    }
+
+    count_ = hdr.count;
+    for (int i = 0; i < count_; ++i) toc_[i].name[sizeof(toc_[i].name) - 1] = '\0';
+    return true;
+}
+
+void LevelPack::close() {
+    finishPending();
+    for (PackFile& f : files_) {
+        f.pack_ = nullptr;
+        f.parked_ = false;
+    }
+    if (file_) {
+        file_->close();
+        file_ = nullptr;
+    }
+    count_ = 0;
+}
+
+bool LevelPack::remount() {
+    if (!backing_ || !path_ || count_ == 0) return false;
+    if (!backing_->remount()) return false;
+
+    // Views keep their offsets; only the shared file underneath them is replaced.
+    finishPending();
+    if (file_) file_->close();
+    file_ = backing_->openPinned(path_);
+    return file_ != nullptr;
+}
+
+int LevelPack::findLevel(const char* path) const {
+    if (!path) return -1;
+
+    const char* name = std::strrchr(path, '/');
+    name = name ? name + 1 : path;
+
+    for (int i = 0; i < count_; ++i) {
+        const char* a = toc_[i].name;
+        const char* b = name;
+        while (*a && std::tolower((unsigned char)*a) == std::tolower((unsigned char)*b)) { ++a; ++b; }
+        if (*a == '\0' && *b == '\0') return i;
+    }
+    return -1;
+}
+
+IFile* LevelPack::openLevel(int i) {
+    if (!file_ || i < 0 || i >= count_) return nullptr;
+
+    for (PackFile& f : files_) {
+        if (f.pack_) continue;
+
+        f.pack_ = this;
+        f.offset_ = toc_[i].offset;
+        f.length_ = toc_[i].length;
+        f.pos_ = 0;
+        f.parked_ = false;
+        return &f;
+    }
+    return nullptr; // all views in use
+}
+
+IFile* LevelPack::openRead(const char* path) {
+    return openLevel(findLevel(path));
+}
+
+} // namespace gv
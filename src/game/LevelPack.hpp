@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include "game/Level.hpp"
+#include "platform/IFileSystem.hpp"
+
+namespace gv {
+
+// ---- GVPK: several level files in one pack ----
+// header(16) | count x PackEntryV1 | level payloads (each a complete GVL1/GVL2 file).
+// The TOC carries a copy of every level header, so listing levels needs no payload reads.
+#pragma pack(push, 1)
+struct PackHeaderV1 {
+    char     magic[4];     // "GVPK"
+    uint8_t  version;      // 1
+    uint8_t  reserved0;    // 0
+    uint16_t count;        // little-endian, number of TOC entries
+    uint32_t tocOffset;    // little-endian, 16
+    uint32_t reserved1;    // 0
+};
+
+struct PackEntryV1 {
+    char          name[12]; // file name, NUL-padded (e.g. "L01.BIN")
+    uint32_t      offset;   // little-endian, payload start in the pack
+    uint32_t      length;   // little-endian, payload bytes
+    LevelHeaderV1 header;   // copy of the payload's first 16 bytes
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PackHeaderV1) == 16, "PackHeaderV1 must be 16 bytes");
+static_assert(sizeof(PackEntryV1) == 36, "PackEntryV1 must be 36 bytes");
+
+class LevelPack;
+
+// Window onto one payload of the pack; offsets are relative to the payload start.
+class PackFile final : public IFile {
+public:
+    bool read(void* dst, size_t bytes, size_t& outRead) override;
+    bool seek(size_t absOffset) override;
+    size_t tell() const override { return pos_; }
+
+    IoStatus readAsync(void* dst, size_t bytes, size_t& outRead) override;
+    IoStatus poll(size_t& outRead) override;
+
+    // The hint goes to the shared pack file, whose window then covers this payload's reads.
+    void hint(AccessPattern pattern, size_t windowBytes = 0) override;
+
+    // close() returns this slot to the pack; the pack file itself stays open.
+    void close() override;
+
+private:
+    friend class LevelPack;
+
+    size_t clampToPayload(size_t bytes) const;
+
+    LevelPack* pack_ = nullptr;  // nullptr = free slot
+    uint32_t offset_ = 0;
+    uint32_t length_ = 0;
+    size_t pos_ = 0;
+
+    // An asynchronous read another view had to finish early; poll() hands it over.
+    bool parked_ = false;
+    IoStatus parkedStatus_ = IoStatus::Done;
+    size_t parkedRead_ = 0;
+};
+
+// IFileSystem over a GVPK pack: the pack is opened once and its TOC kept in RAM.
+// openRead() matches the file name part of the path against the TOC (case-insensitive),
+// so "levels/L02.BIN" finds the pack's "L02.BIN".
+class LevelPack final : public IFileSystem {
+public:
+    static constexpr int kMaxLevels = 32;
+    static constexpr int kMaxOpen = 2;
+
+    // path must outlive the pack: remount() reopens it.
+    bool open(IFileSystem& backing, const char* path);
+    void close();
+
+    bool init() override { return file_ != nullptr; }
+    IFile* openRead(const char* path) override;
+    bool mediaPresent() const override { return backing_ && backing_->mediaPresent(); }
+    void checkMedia() override {
+        if (backing_) backing_->checkMedia();
+    }
+    // Remounts the backing storage and reopens the pack file; the TOC in RAM is kept.
+    bool remount() override;
+    IoStats stats() const override { return backing_ ? backing_->stats() : IoStats{}; }
+
+    int levelCount() const { return count_; }
+    const char* levelName(int i) const { return toc_[i].name; }
+    const LevelHeaderV1& levelHeader(int i) const { return toc_[i].header; }
+    int findLevel(const char* path) const;
+    IFile* openLevel(int i);
+
+private:
+    friend class PackFile;
+
+    // The shared file runs one request at a time, so a view that needs it while another
+    // view's read is in flight finishes that read first and parks the result with its owner.
+    void finishPending();
+
+    IFileSystem* backing_ = nullptr;
+    const char* path_ = nullptr;
+    IFile* file_ = nullptr;          // nullptr while a remount could not reopen it
+    PackFile* pending_ = nullptr;    // view whose asynchronous read is in flight on file_
+    int count_ = 0;
+    PackEntryV1 toc_[kMaxLevels]{};
+    PackFile files_[kMaxOpen];
+};
+
+} // namespace gv
@@ -0,0 +1,137 @@
+#include "LevelSource.hpp"
+#include <cstring>
+
+namespace gv {
+
+bool LevelSource::open(IFileSystem& fs, const char* path) {
+    close();
+
+    if (!openFile(fs, path)) return false;
+
+    size_t got = 0;
+    if (!file_->seek(0)) { close(); return false; }
+    if (!file_->read(&hdr_, sizeof(LevelHeaderV1), got) || got != sizeof(LevelHeaderV1)) {
+        close();
+        return false;
+    }
+
+    const bool v1 = std::memcmp(hdr_.magic, "GVL1", 4) == 0 && hdr_.version == 1;
+    const bool v2 = std::memcmp(hdr_.magic, "GVL2", 4) == 0 && hdr_.version == 2;
+    if (!v1 && !v2) { close(); return false; }
+    if (hdr_.height != kLevelHeight) { close(); return false; }
+    if (hdr_.width > kMaxLevelWidth) { close(); return false; }
+    if (v2 && !loadInfoV2()) { close(); return false; }
+    return true;
+}
+
+bool LevelSource::reopen(IFileSystem& fs) {
+    closeFile();
+    return path_ && openFile(fs, path_);
+}
+
+bool LevelSource::openFile(IFileSystem& fs, const char* path) {
+    path_ = path;
+    file_ = fs.openPinned(path);
+    if (!file_) return false;
+
+    // Scrolling only moves forward, so fetches keep landing just past the last one.
+    file_->hint(AccessPattern::ForwardWindow, kLevelReadAheadBytes);
+    return true;
+}
+
+void LevelSource::closeFile() {
+    if (file_) {
+        file_->close();
+        file_ = nullptr;
+    }
+}
+
+void LevelSource::close() {
+    closeFile();
+    std::memset(&hdr_, 0, sizeof(hdr_));
+    path_ = nullptr;
+    isV2_ = false;
+}
+
+bool LevelSource::loadInfoV2() {
+    size_t got = 0;
+    if (!file_->read(&info2_, sizeof(info2_), got) || got != sizeof(info2_)) return false;
+
+    // Blocks must fit a fetch unit so a whole block always lands inside the cache window.
+    if (info2_.blockShift > 15 || (1 << info2_.blockShift) > kColsPrefetch) return false;
+    if (info2_.dictCount > kMaxLevelDict) return false;
+
+    const int blockCols = 1 << info2_.blockShift;
+    if (int(info2_.blockCount) != (int(hdr_.width) + blockCols - 1) / blockCols) return false;
+    if (info2_.blockCount > kMaxLevelBlocks) return false;
+
+    const size_t dictBytes = size_t(info2_.dictCount) * kColumnBytes;
+    if (dictBytes && (!file_->read(dict_, dictBytes, got) || got != dictBytes)) return false;
+
+    // The offset table follows the dictionary: blockCount + 1 little-endian uint32.
+    uint8_t* raw = reinterpret_cast<uint8_t*>(blockOffsets_);
+    const size_t tableBytes = (size_t(info2_.blockCount) + 1) * sizeof(uint32_t);
+    if (!file_->read(raw, tableBytes, got) || got != tableBytes) return false;
+    for (int i = 0; i <= int(info2_.blockCount); ++i) {
+        const uint8_t* b = raw + size_t(i) * sizeof(uint32_t);
+        blockOffsets_[i] = uint32_t(b[0]) | (uint32_t(b[1]) << 8) | (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 24);
+    }
+
+    isV2_ = true;
+    return true;
+}
+
+bool LevelSource::locateUnit(int first, size_t& offset, size_t& bytes) const {
+    const int count = unitCount(first);
+
+    if (!isV2_) {
+        offset = sizeof(LevelHeaderV1) + size_t(first) * kColumnBytes;
+        bytes = size_t(count) * kColumnBytes;
+        return true;
+    }
+
+    // GVL2: the block's extent is two neighbouring entries of the offset table.
+    const uint32_t* ext = blockOffsets_ + (first >> info2_.blockShift);
+    if (ext[1] < ext[0] || ext[1] - ext[0] > kUnitBytes) return false;
+
+    offset = ext[0];
+    bytes = ext[1] - ext[0];
+    return true;
+}
+
+bool LevelSource::decodeUnit(int first, const uint8_t* src, size_t bytes, Column56* out) const {
+    const int count = unitCount(first);
+
+    if (!isV2_) {
+        if (bytes != size_t(count) * kColumnBytes) return false;
+        std::memcpy(out, src, bytes);
+        return true;
+    }
+    return decode_block_v2(src, bytes, dict_, info2_.dictCount, out, count);
+}
+
+bool LevelSource::readUnit(int first, uint8_t* buf, Column56* out) const {
+    size_t offset = 0, bytes = 0, got = 0;
+    if (!locateUnit(first, offset, bytes)) return false;
+    if (!file_->seek(offset)) return false;
+    if (!file_->read(buf, bytes, got) || got != bytes) return false;
+    return decodeUnit(first, buf, bytes, out);
+}
+
+bool LevelSource::readColumns(int first, int end, uint8_t* buf, Column56* out) const {
+    if (!isV2_) {
+        // Raw columns sit back to back after the header: one sequential read.
+        const size_t bytes = size_t(end - first) * kColumnBytes;
+        size_t got = 0;
+        if (!file_->seek(sizeof(LevelHeaderV1) + size_t(first) * kColumnBytes)) return false;
+        return file_->read(out, bytes, got) && got == bytes;
+    }
+
+    // Blocks are stored in column order, so this walks the file front to back.
+    for (int c = first; c < end; c += unitCols()) {
+        if (!readUnit(c, buf, out + (c - first))) return false;
+    }
+    return true;
+}
+
+} // namespace gv
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "app/Config.hpp"
+#include "game/Level.hpp"
+#include "platform/IFileSystem.hpp"
+
+namespace gv {
+
+// One level file: its header, GVL2 block geometry and dictionary, and reads by fetch unit.
+// A unit starts on a unit boundary: kColsPrefetch raw columns (GVL1) or one compressed block (GVL2).
+class LevelSource {
+public:
+    // Largest unit on disk: a GVL2 block with a literal token (1 + 7 bytes) per column.
+    static constexpr size_t kUnitBytes = kColsPrefetch * (1 + kColumnBytes);
+
+    // open() reads and checks the header (plus the GVL2 info and dictionary).
+    // path must outlive the source: reopen() uses it again.
+    bool open(IFileSystem& fs, const char* path);
+    // reopen() gets a fresh file for the same level, e.g. after the card was swapped back in.
+    // The header, block geometry and dictionary stay as they are; nothing is read.
+    bool reopen(IFileSystem& fs);
+    // closeFile() releases the file but keeps the header, e.g. once a level is resident.
+    void closeFile();
+    void close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    IFile* file() const { return file_; }
+    const LevelHeaderV1& header() const { return hdr_; }
+
+    int unitCols() const { return isV2_ ? (1 << info2_.blockShift) : kColsPrefetch; }
+    int unitCount(int first) const {
+        const int n = int(hdr_.width) - first;
+        return (n < unitCols()) ? n : unitCols();
+    }
+
+    bool locateUnit(int first, size_t& offset, size_t& bytes) const;
+    bool decodeUnit(int first, const uint8_t* src, size_t bytes, Column56* out) const;
+    bool readUnit(int first, uint8_t* buf, Column56* out) const;
+
+    // Columns first..end-1 into out; first must start a unit. GVL1 is one sequential read.
+    bool readColumns(int first, int end, uint8_t* buf, Column56* out) const;
+
+private:
+    bool openFile(IFileSystem& fs, const char* path);
+    bool loadInfoV2();
+
+    IFile* file_ = nullptr;      // IFileSystem owns the backing file; keep a pointer while open.
+    const char* path_ = nullptr;
+    LevelHeaderV1 hdr_{};
+
+    // GVL2 only: block geometry, column dictionary and the block offset table, so finding a
+    // block needs no read of its own.
+    bool isV2_ = false;
+    LevelInfoV2 info2_{};
+    Column56 dict_[kMaxLevelDict]{};
+    uint32_t blockOffsets_[kMaxLevelBlocks + 1]{};
+};
+
+} // namespace gv
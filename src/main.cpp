@@ -4,6 +4,7 @@
 namespace gv { IPlatform* createPlatform(); }
 
 int main() {
-    gv::App app;
+    // Static: Game carries the column cache, which is too big for the default core0 stack.
+    static gv::App app;
     return app.run(*gv::createPlatform());
 }
\ No newline at end of file
@@ -4,6 +4,27 @@
 
 namespace gv {
 
+enum class IoStatus : uint8_t { Done, Pending, Error };
+
+// How a file is about to be read, so the implementation can buffer for it.
+enum class AccessPattern : uint8_t {
+    Random,         // scattered reads; no read-ahead (the default)
+    Sequential,     // front to back
+    ForwardWindow,  // moving forward, with seeks back and forth inside a window of n bytes
+};
+
+// Cumulative storage counters. Take two snapshots and subtract for a rate.
+struct IoStats {
+    uint32_t blocksRead = 0;     // blocks fetched from the card
+    uint32_t fatReads = 0;       // FAT entries looked up while following cluster chains
+    uint32_t cacheHits = 0;      // sector reads served from RAM
+    uint32_t cacheMisses = 0;    // sector reads that went to the card
+    uint32_t bytesRead = 0;      // file bytes handed to callers
+    uint32_t commands = 0;       // card commands issued
+    uint64_t busyUs = 0;         // time with the card selected
+    uint32_t windowHits = 0;     // file reads served from a read-ahead window, no FAT32 call
+};
+
 class IFile {
 public:
     virtual ~IFile() = default;
@@ -12,6 +33,23 @@ public:
     virtual bool seek(size_t absOffset) = 0;
     virtual size_t tell() const = 0;
 
+    // readAsync() starts a read at the current position. Done means outRead is valid now;
+    // Pending means call poll() until it returns Done, keeping dst alive and the file untouched.
+    // Either may read fewer bytes than asked. The defaults complete synchronously.
+    virtual IoStatus readAsync(void* dst, size_t bytes, size_t& outRead) {
+        return read(dst, bytes, outRead) ? IoStatus::Done : IoStatus::Error;
+    }
+    virtual IoStatus poll(size_t& outRead) {
+        outRead = 0;
+        return IoStatus::Done;
+    }
+
+    // hint() describes the reads to come; windowBytes only applies to ForwardWindow.
+    virtual void hint(AccessPattern pattern, size_t windowBytes = 0) {
+        (void)pattern;
+        (void)windowBytes;
+    }
+
     // close() releases all resources for this file.
     // Implementations may self-delete; the pointer is invalid after close().
     virtual void close() = 0;
@@ -28,6 +66,24 @@ public:
     // Multiple files may be open concurrently.
     // The returned pointer remains valid until close() is called.
     virtual IFile* openRead(const char* path) = 0; // returns nullptr on fail
+
+    // openPinned() is openRead() for files kept open for a whole run: the backend may spend
+    // time and memory at open so later seeks cost nothing. Falls back to openRead().
+    virtual IFile* openPinned(const char* path) { return openRead(path); }
+
+    // mediaPresent() is a cheap check (no I/O) that removable storage is in place.
+    virtual bool mediaPresent() const { return true; }
+
+    // checkMedia() drops everything cached from media that was removed, including a removal
+    // only noted by an interrupt. Cheap (no I/O); call it from the main loop between frames.
+    virtual void checkMedia() {}
+
+    // remount() brings storage back after the media was removed and reinserted. It blocks,
+    // so call it between frames. Files opened before the removal fail until reopened.
+    virtual bool remount() { return true; }
+
+    // stats() snapshots the storage counters; all zero when the backend keeps none.
+    virtual IoStats stats() const { return IoStats{}; }
 };
 
 } // namespace gv
\ No newline at end of file
@@ -11,6 +11,7 @@ public:
     virtual ~IPlatform() = default;
     virtual void init() = 0;
     virtual uint32_t dtUs() = 0;
+    virtual uint64_t nowUs() = 0;   // monotonic clock, for in-frame time budgets
     virtual IDisplay& display() = 0;
     virtual IFileSystem& fs() = 0;
     virtual IInput& input() = 0;
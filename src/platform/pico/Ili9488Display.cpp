@@ -81,6 +81,8 @@ void Ili9488Display::drawLines(const DrawList& dl) {
 
     lastLines  = f.lineCount;
     lastBinned = f.binnedTotal;
+    lastDrawn  = (int)dl.get().size();
+    lastHidden = dl.hiddenCount();
 }
 
 void Ili9488Display::endFrame() {
@@ -113,8 +115,31 @@ void Ili9488Display::endFrame() {
 
     uint64_t now = time_us_64();
     if (now - t0 >= 1000000) {
-        printf("SPI:%u FPS:%u Lines:%d Binned:%d\n",
+        printf("SPI:%u FPS:%u Lines:%d Binned:%d",
                g_baud, frames, lastLines, lastBinned);
+
+        // Hidden-edge mode: lines the renderer left out, as a share of the full wireframe.
+        if (lastHidden > 0)
+            printf(" Hidden:%d(%d%%)", lastHidden, lastHidden * 100 / (lastDrawn + lastHidden));
+
+        if (ioFs) {
+            // Per-frame averages over the last second, in hundredths.
+            const IoStats io = ioFs->stats();
+            const uint32_t blk  = (io.blocksRead - lastIo.blocksRead) * 100 / frames;
+            const uint32_t fat  = (io.fatReads - lastIo.fatReads) * 100 / frames;
+            const uint32_t hits = io.cacheHits - lastIo.cacheHits;
+            const uint32_t look = hits + (io.cacheMisses - lastIo.cacheMisses);
+            const uint32_t busy = (uint32_t)((io.busyUs - lastIo.busyUs) / frames);
+            printf(" IO/f blk:%lu.%02lu fat:%lu.%02lu B:%lu hit:%lu%% cs:%luus",
+                   (unsigned long)(blk / 100), (unsigned long)(blk % 100),
+                   (unsigned long)(fat / 100), (unsigned long)(fat % 100),
+                   (unsigned long)((io.bytesRead - lastIo.bytesRead) / frames),
+                   (unsigned long)(look ? hits * 100 / look : 100),
+                   (unsigned long)busy);
+            lastIo = io;
+        }
+
+        printf("\n");
         frames = 0;
         t0 = now;
     }
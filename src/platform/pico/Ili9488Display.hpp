@@ -1,5 +1,6 @@
 #pragma once
 #include "../IDisplay.hpp"
+#include "../IFileSystem.hpp"
 #include <cstdint>
 #include <cstddef>
 
@@ -17,6 +18,9 @@ public:
     void drawLines(const DrawList& dl) override;
     void endFrame() override;
 
+    // Storage whose per-frame I/O is appended to the once-per-second FPS line.
+    void setIoSource(const IFileSystem* fs) { ioFs = fs; }
+
     static constexpr int W = 320;
     static constexpr int H = 320;
     static constexpr int SLAB_ROWS = 8;
@@ -62,6 +66,10 @@ private:
     // Stats (core0)
     int lastLines = 0;
     int lastBinned = 0;
+    int lastDrawn  = 0; // DrawList size before clipping
+    int lastHidden = 0;
+    const IFileSystem* ioFs = nullptr;
+    IoStats lastIo{};
 
 private:
     void lcdFillBlack();
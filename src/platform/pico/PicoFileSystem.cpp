@@ -1,38 +1,180 @@
 #include "PicoFileSystem.hpp"
+#include <cstring>
 
-extern "C" {
-#include "sdcard.h"
-#include "fat32.h"
+namespace gv {
+
+uint32_t FatFile::windowHits_ = 0;
+
+bool FatFile::open(const char* path, bool pinned) {
+    pos_ = 0;
+    window_ = 0;
+    winStart_ = 0;
+    winLen_ = 0;
+    winPending_ = false;
+    const fat32_error_t err = pinned ? fat32_open_pinned(&f_, path) : fat32_open(&f_, path);
+    if (err != FAT32_OK || (f_.attributes & FAT32_ATTR_DIRECTORY)) {
+        fat32_close(&f_);
+        return false;
+    }
+    return true;
 }
 
-namespace gv {
+size_t FatFile::windowLength(size_t start) const {
+    const size_t left = (start < f_.file_size) ? f_.file_size - start : 0;
+    return (left < window_) ? left : window_;
+}
 
-bool PicoFile::read(void* dst, size_t bytes, size_t& outRead) {
+size_t FatFile::copyFromWindow(void* dst, size_t bytes) {
+    if (pos_ < winStart_ || pos_ >= winStart_ + winLen_) return 0;
+    const size_t avail = winStart_ + winLen_ - pos_;
+    const size_t n = (bytes < avail) ? bytes : avail;
+    memcpy(dst, win_ + (pos_ - winStart_), n);
+    pos_ += n;
+    return n;
+}
+
+bool FatFile::readDirect(void* dst, size_t bytes, size_t& outRead) {
+    if (f_.position != pos_ && fat32_seek(&f_, (uint32_t)pos_) != FAT32_OK) return false;
+    const bool ok = fat32_read(&f_, dst, bytes, &outRead) == FAT32_OK;
+    pos_ = f_.position;
+    return ok;
+}
+
+bool FatFile::fillWindow() {
+    const size_t start = windowStart();
+    size_t got = 0;
+    winStart_ = start;
+    winLen_ = 0;
+    if (fat32_seek(&f_, (uint32_t)start) != FAT32_OK) return false;
+    if (fat32_read(&f_, win_, windowLength(start), &got) != FAT32_OK) return false;
+    winLen_ = got;
+    return true;
+}
+
+bool FatFile::read(void* dst, size_t bytes, size_t& outRead) {
     outRead = 0;
-    if (!f_) return false;
-    outRead = std::fread(dst, 1, bytes, f_);
+    if (!f_.is_open || winPending_) return false;
+
+    // Unbuffered, or big enough that the window would only add a copy.
+    if (window_ == 0 || bytes >= window_) return readDirect(dst, bytes, outRead);
+
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    bool filled = false;
+    while (outRead < bytes) {
+        size_t n = copyFromWindow(out + outRead, bytes - outRead);
+        if (n == 0) {
+            if (!fillWindow()) return false;
+            filled = true;
+            n = copyFromWindow(out + outRead, bytes - outRead);
+            if (n == 0) break; // end of file
+        }
+        outRead += n;
+    }
+    if (!filled && outRead > 0) ++windowHits_;
+    return true;
+}
+
+bool FatFile::seek(size_t absOffset) {
+    if (!f_.is_open || winPending_) return false;
+    // Only the logical position moves; FAT32 is repositioned on the next miss.
+    pos_ = absOffset;
     return true;
 }
 
-bool PicoFile::seek(size_t absOffset) {
-    if (!f_) return false;
-    return std::fseek(f_, (long)absOffset, SEEK_SET) == 0;
+IoStatus FatFile::readAsync(void* dst, size_t bytes, size_t& outRead) {
+    outRead = 0;
+    if (!f_.is_open || winPending_) return IoStatus::Error;
+
+    if (window_ == 0 || bytes >= window_) {
+        if (f_.position != pos_ && fat32_seek(&f_, (uint32_t)pos_) != FAT32_OK) return IoStatus::Error;
+
+        bool done = false;
+        const fat32_error_t err = fat32_read_async(&f_, dst, bytes, &done, &outRead);
+
+        // Another file owns the async slot; a blocking read is still correct.
+        if (err == FAT32_ERROR_BUSY) return readDirect(dst, bytes, outRead) ? IoStatus::Done : IoStatus::Error;
+        if (err != FAT32_OK) return IoStatus::Error;
+        if (done) pos_ = f_.position;
+        return done ? IoStatus::Done : IoStatus::Pending;
+    }
+
+    // A window hit completes at once; a partial hit returns short and the caller asks again.
+    outRead = copyFromWindow(dst, bytes);
+    if (outRead > 0) {
+        ++windowHits_;
+        return IoStatus::Done;
+    }
+
+    const size_t start = windowStart();
+    bool done = false;
+    size_t got = 0;
+    winStart_ = start;
+    winLen_ = 0;
+    if (fat32_seek(&f_, (uint32_t)start) != FAT32_OK) return IoStatus::Error;
+    const fat32_error_t err = fat32_read_async(&f_, win_, windowLength(start), &done, &got);
+
+    if (err == FAT32_ERROR_BUSY) {
+        if (!fillWindow()) return IoStatus::Error;
+        outRead = copyFromWindow(dst, bytes);
+        return IoStatus::Done;
+    }
+    if (err != FAT32_OK) return IoStatus::Error;
+    if (done) {
+        winLen_ = got;
+        outRead = copyFromWindow(dst, bytes);
+        return IoStatus::Done;
+    }
+
+    winPending_ = true;
+    asyncDst_ = static_cast<uint8_t*>(dst);
+    asyncBytes_ = bytes;
+    return IoStatus::Pending;
 }
 
-size_t PicoFile::tell() const {
-    if (!f_) return 0;
-    long p = std::ftell(f_);
-    return (p < 0) ? 0 : (size_t)p;
+IoStatus FatFile::poll(size_t& outRead) {
+    outRead = 0;
+    bool done = true;
+    size_t got = 0;
+    if (fat32_read_async_poll(&f_, &done, &got) != FAT32_OK) {
+        winPending_ = false;
+        return IoStatus::Error;
+    }
+    if (!done) return IoStatus::Pending;
+
+    if (!winPending_) {
+        outRead = got;
+        pos_ = f_.position;
+        return IoStatus::Done;
+    }
+
+    // The window refill landed; hand the caller its slice.
+    winPending_ = false;
+    winLen_ = got;
+    outRead = copyFromWindow(asyncDst_, asyncBytes_);
+    return IoStatus::Done;
 }
 
-void PicoFile::close() {
-    if (f_) {
-        std::fclose(f_);
-        f_ = nullptr;
+void FatFile::hint(AccessPattern pattern, size_t windowBytes) {
+    if (winPending_) return;
+
+    size_t w = 0;
+    if (pattern == AccessPattern::Sequential) {
+        w = kWindowBytes;
+    } else if (pattern == AccessPattern::ForwardWindow) {
+        // Whole sectors, so every refill is an aligned run FAT32 reads straight into win_.
+        w = (windowBytes + FAT32_SECTOR_SIZE - 1) / FAT32_SECTOR_SIZE * FAT32_SECTOR_SIZE;
+        if (w == 0 || w > kWindowBytes) w = kWindowBytes;
     }
+    window_ = w;
+    winLen_ = 0;
+}
 
-    // This file wrapper is heap-allocated by PicoFileSystem::openRead().
-    delete this;
+void FatFile::close() {
+    // fat32_close() clears the handle, which frees the pool slot.
+    fat32_close(&f_);
+    window_ = 0;
+    winLen_ = 0;
+    winPending_ = false;
 }
 
 bool PicoFileSystem::init() {
@@ -48,14 +190,49 @@ bool PicoFileSystem::init() {
     return true;
 }
 
+bool PicoFileSystem::remount() {
+    if (!inited_) return init();
+
+    // fat32_is_ready() mounts a present card; file reads never do that on their own.
+    return fat32_is_ready();
+}
+
 IFile* PicoFileSystem::openRead(const char* path) {
+    return openSlot(path, false);
+}
+
+IFile* PicoFileSystem::openPinned(const char* path) {
+    return openSlot(path, true);
+}
+
+IFile* PicoFileSystem::openSlot(const char* path, bool pinned) {
     if (!inited_) return nullptr;
 
-    FILE* f = std::fopen(path, "rb");
-    if (!f) return nullptr;
+    // Each open takes a distinct slot so multiple files can be open concurrently.
+    for (FatFile& file : files_) {
+        if (file.f_.is_open) continue;
+
+        return file.open(path, pinned) ? &file : nullptr;
+    }
+    return nullptr; // pool exhausted
+}
+
+IoStats PicoFileSystem::stats() const {
+    fat32_cache_stats_t fs{};
+    sd_stats_t sd{};
+    fat32_get_cache_stats(&fs);
+    sd_get_stats(&sd);
 
-    // Each open returns a distinct wrapper so multiple files can be open concurrently.
-    return new PicoFile(f);
+    IoStats s;
+    s.blocksRead  = fs.blocks_read;
+    s.fatReads    = fs.fat_reads;
+    s.cacheHits   = fs.hits;
+    s.cacheMisses = fs.misses;
+    s.bytesRead   = fs.bytes_read;
+    s.commands    = sd.commands;
+    s.busyUs      = sd.cs_time_us;
+    s.windowHits  = FatFile::windowHits_;
+    return s;
 }
 
-} // namespace gv
\ No newline at end of file
+} // namespace gv
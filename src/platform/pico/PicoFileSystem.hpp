@@ -1,31 +1,81 @@
 #pragma once
 #include "platform/IFileSystem.hpp"
-#include <cstdio>
+
+extern "C" {
+#include "sdcard.h"
+#include "fat32.h"
+}
 
 namespace gv {
 
-class PicoFile final : public IFile {
+// IFile directly over a fat32_file_t: reads land in the caller's buffer with no stdio layer.
+// Instances live in PicoFileSystem's fixed pool; an unopened fat32_file_t marks a free slot.
+//
+// With a Sequential or ForwardWindow hint the file keeps a sector-aligned read-ahead window:
+// seeks only move pos_, and reads inside the window are a memcpy with no FAT32 call.
+class FatFile final : public IFile {
 public:
-    explicit PicoFile(FILE* f) : f_(f) {}
+    // Matches FAT32_ASYNC_MAX_SECTORS, so one asynchronous read can refill the whole window.
+    static constexpr size_t kWindowBytes = FAT32_ASYNC_MAX_SECTORS * FAT32_SECTOR_SIZE;
 
     bool read(void* dst, size_t bytes, size_t& outRead) override;
     bool seek(size_t absOffset) override;
-    size_t tell() const override;
+    size_t tell() const override { return pos_; }
+
+    IoStatus readAsync(void* dst, size_t bytes, size_t& outRead) override;
+    IoStatus poll(size_t& outRead) override;
+
+    void hint(AccessPattern pattern, size_t windowBytes = 0) override;
 
-    // close() closes the FILE and deletes this wrapper.
+    // close() closes the FAT file and returns this slot to the pool.
     void close() override;
 
 private:
-    FILE* f_ = nullptr;
+    friend class PicoFileSystem;
+
+    bool open(const char* path, bool pinned);
+    bool readDirect(void* dst, size_t bytes, size_t& outRead);
+    bool fillWindow();
+    size_t copyFromWindow(void* dst, size_t bytes);
+    size_t windowStart() const { return pos_ - pos_ % FAT32_SECTOR_SIZE; }
+    size_t windowLength(size_t start) const;
+
+    static uint32_t windowHits_; // shared by the pool, reported through PicoFileSystem::stats()
+
+    fat32_file_t f_{};
+    size_t pos_ = 0;             // logical position; f_.position is only synced before a FAT32 call
+
+    size_t window_ = 0;          // read-ahead size in bytes, 0 = unbuffered
+    size_t winStart_ = 0;        // file offset of win_[0]
+    size_t winLen_ = 0;          // valid bytes in win_
+    uint8_t win_[kWindowBytes] __attribute__((aligned(4)));
+
+    // Asynchronous window refill: the caller's buffer is filled from the window on completion.
+    bool winPending_ = false;
+    uint8_t* asyncDst_ = nullptr;
+    size_t asyncBytes_ = 0;
 };
 
 class PicoFileSystem final : public IFileSystem {
 public:
+    static constexpr int kMaxFiles = 4;
+
     bool init() override;
     IFile* openRead(const char* path) override;
+    // Maps the file's cluster chain into the FAT32 extent pool (see fat32_open_pinned).
+    IFile* openPinned(const char* path) override;
+    // Reads the card-detect switch; remount() re-initialises the card and mounts it.
+    bool mediaPresent() const override { return sd_card_present(); }
+    // The card-detect timer only flags a removal; the unmount happens here.
+    void checkMedia() override { fat32_check_card(); }
+    bool remount() override;
+    IoStats stats() const override;
 
 private:
+    IFile* openSlot(const char* path, bool pinned);
+
     bool inited_ = false;
+    FatFile files_[kMaxFiles];
 };
 
-} // namespace gv
\ No newline at end of file
+} // namespace gv
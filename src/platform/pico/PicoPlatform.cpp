@@ -14,6 +14,7 @@ public:
         last = time_us_64();
 
         kb_.init();
+        disp.setIoSource(&fs_);
     }
 
     uint32_t dtUs() override {
@@ -23,6 +24,8 @@ public:
         return (uint32_t)us;
     }
 
+    uint64_t nowUs() override { return time_us_64(); }
+
     IDisplay& display() override { return disp; }
     IFileSystem& fs() override { return fs_; }
     IInput& input() override { return kb_; }
@@ -0,0 +1,91 @@
+#pragma once
+
+//
+//  Block device interface underneath the FAT32 driver
+//
+//  fat32.c reaches storage only through a blockdev_t, so the same file system
+//  code runs on the SD card (blockdev_sd), on a disk image file in a host build
+//  (blockdev_file) or behind a wrapper that charges modelled SPI SD timings
+//  (blockdev_latency). Blocks are SD_BLOCK_SIZE bytes and results use sd_error_t.
+//
+//  Define FAT32_HOST to build fat32.c and the host backends without the Pico SDK.
+//
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "sdcard.h"
+
+typedef struct
+{
+    void *context;
+
+    bool (*present)(void *context);
+    sd_error_t (*init)(void *context); // (Re)initialise the medium, called on every mount
+    sd_error_t (*read_blocks)(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer);
+    sd_error_t (*write_blocks)(void *context, uint32_t start_block, uint32_t num_blocks, const uint8_t *buffer);
+
+    // Asynchronous reads follow the sd_read_blocks_async() contract: one transfer at a
+    // time, async_poll() returns true while it is in flight, async_wait() finishes it.
+    sd_error_t (*read_blocks_async)(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer,
+                                    sd_async_callback_t callback, void *callback_context);
+    bool (*async_poll)(void *context);
+    void (*async_wait)(void *context);
+} blockdev_t;
+
+#ifndef FAT32_HOST
+// SD card on SPI0 (sdcard.c)
+const blockdev_t *blockdev_sd(void);
+#endif
+
+// Disk image file. The FILE must be opened "r+b" (or "rb" for a read-only image).
+typedef struct
+{
+    blockdev_t device;   // Returned by blockdev_file_init()
+    FILE *image;
+    uint32_t num_blocks; // Blocks in the image, from its size
+    struct
+    {
+        sd_async_callback_t callback;
+        void *context;
+        sd_error_t result;
+    } pending;           // Reads "complete" on the next poll
+} blockdev_file_t;
+
+const blockdev_t *blockdev_file_init(blockdev_file_t *file, FILE *image);
+
+// Latency model of an SD card in SPI mode, wrapped around another device.
+// Times are simulated: nothing sleeps, the cost of each access is added to the
+// counters so a host run can report I/O time per frame.
+typedef struct
+{
+    uint32_t spi_hz;           // SPI clock (SD_BAUDRATE)
+    uint32_t command_us;       // Command, response and CS framing per transfer
+    uint32_t read_access_us;   // Card access time before the first data token
+    uint32_t block_gap_us;     // Extra wait between blocks of a multi-block read
+    uint32_t write_busy_us;    // Programming time after each written block
+} blockdev_latency_model_t;
+
+typedef struct
+{
+    uint64_t elapsed_us;       // Simulated time spent in the device
+    uint32_t transfers;        // Commands issued (one per read/write call)
+    uint32_t blocks_read;
+    uint32_t blocks_written;
+} blockdev_latency_stats_t;
+
+typedef struct
+{
+    blockdev_t device;         // Returned by blockdev_latency_init()
+    const blockdev_t *inner;
+    blockdev_latency_model_t model;
+    blockdev_latency_stats_t stats;
+} blockdev_latency_t;
+
+// Typical SDHC card on a 25 MHz SPI bus
+void blockdev_latency_default_model(blockdev_latency_model_t *model);
+const blockdev_t *blockdev_latency_init(blockdev_latency_t *latency, const blockdev_t *inner,
+                                        const blockdev_latency_model_t *model);
+void blockdev_latency_reset_stats(blockdev_latency_t *latency);
@@ -0,0 +1,130 @@
+//
+//  Disk image block device for host builds
+//
+//  Serves blocks from a raw image file (e.g. a dd of an SD card), so the
+//  FAT32 driver can run and be measured on a desktop machine.
+//
+
+#include <string.h>
+#include <stdio.h>
+
+#include "blockdev.h"
+
+static bool file_present(void *context)
+{
+    blockdev_file_t *file = (blockdev_file_t *)context;
+    return file->image != NULL;
+}
+
+static sd_error_t file_init(void *context)
+{
+    blockdev_file_t *file = (blockdev_file_t *)context;
+    return file->image ? SD_OK : SD_ERROR_NO_CARD;
+}
+
+static sd_error_t file_read_blocks(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer)
+{
+    blockdev_file_t *file = (blockdev_file_t *)context;
+    if (!file->image)
+    {
+        return SD_ERROR_NO_CARD;
+    }
+    if (start_block + num_blocks > file->num_blocks || start_block + num_blocks < start_block)
+    {
+        return SD_ERROR_READ_FAILED;
+    }
+
+    if (fseek(file->image, (long)start_block * SD_BLOCK_SIZE, SEEK_SET) != 0 ||
+        fread(buffer, SD_BLOCK_SIZE, num_blocks, file->image) != num_blocks)
+    {
+        return SD_ERROR_READ_FAILED;
+    }
+    return SD_OK;
+}
+
+static sd_error_t file_write_blocks(void *context, uint32_t start_block, uint32_t num_blocks, const uint8_t *buffer)
+{
+    blockdev_file_t *file = (blockdev_file_t *)context;
+    if (!file->image)
+    {
+        return SD_ERROR_NO_CARD;
+    }
+    if (start_block + num_blocks > file->num_blocks || start_block + num_blocks < start_block)
+    {
+        return SD_ERROR_WRITE_FAILED;
+    }
+
+    if (fseek(file->image, (long)start_block * SD_BLOCK_SIZE, SEEK_SET) != 0 ||
+        fwrite(buffer, SD_BLOCK_SIZE, num_blocks, file->image) != num_blocks)
+    {
+        return SD_ERROR_WRITE_FAILED;
+    }
+    return SD_OK;
+}
+
+static void file_async_complete(blockdev_file_t *file)
+{
+    sd_async_callback_t callback = file->pending.callback;
+    file->pending.callback = NULL;
+    callback(file->pending.result, file->pending.context);
+}
+
+// The data is copied at once; completion is reported on the next poll so callers
+// see the same start/poll sequence as on the card.
+static sd_error_t file_read_blocks_async(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer,
+                                         sd_async_callback_t callback, void *callback_context)
+{
+    blockdev_file_t *file = (blockdev_file_t *)context;
+    if (file->pending.callback)
+    {
+        file_async_complete(file);
+    }
+
+    sd_error_t result = file_read_blocks(context, start_block, num_blocks, buffer);
+    if (result != SD_OK)
+    {
+        return result;
+    }
+
+    file->pending.callback = callback;
+    file->pending.context = callback_context;
+    file->pending.result = result;
+    return SD_OK;
+}
+
+static bool file_async_poll(void *context)
+{
+    blockdev_file_t *file = (blockdev_file_t *)context;
+    if (file->pending.callback)
+    {
+        file_async_complete(file);
+    }
+    return false;
+}
+
+static void file_async_wait(void *context)
+{
+    file_async_poll(context);
+}
+
+const blockdev_t *blockdev_file_init(blockdev_file_t *file, FILE *image)
+{
+    memset(file, 0, sizeof(*file));
+    file->image = image;
+
+    if (image && fseek(image, 0, SEEK_END) == 0)
+    {
+        long size = ftell(image);
+        file->num_blocks = size > 0 ? (uint32_t)(size / SD_BLOCK_SIZE) : 0;
+    }
+
+    file->device.context = file;
+    file->device.present = file_present;
+    file->device.init = file_init;
+    file->device.read_blocks = file_read_blocks;
+    file->device.write_blocks = file_write_blocks;
+    file->device.read_blocks_async = file_read_blocks_async;
+    file->device.async_poll = file_async_poll;
+    file->device.async_wait = file_async_wait;
+    return &file->device;
+}
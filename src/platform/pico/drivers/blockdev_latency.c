@@ -0,0 +1,138 @@
+//
+//  SD card latency model
+//
+//  Wraps another block device and charges every access the time it would
+//  take on an SD card in SPI mode: command framing, the card's access time
+//  before the first data token, the data itself at the SPI clock, and the
+//  programming time after a write. Time is only accounted, never spent.
+//
+
+#include <string.h>
+
+#include "blockdev.h"
+
+#define LATENCY_BLOCK_FRAME_BYTES (SD_BLOCK_SIZE + 3) // Data token + block + CRC
+
+static uint32_t latency_bytes_us(const blockdev_latency_model_t *model, uint32_t bytes)
+{
+    return (uint32_t)(((uint64_t)bytes * 8u * 1000000u + model->spi_hz - 1) / model->spi_hz);
+}
+
+static void latency_charge_read(blockdev_latency_t *latency, uint32_t num_blocks)
+{
+    const blockdev_latency_model_t *model = &latency->model;
+    if (num_blocks == 0)
+    {
+        return;
+    }
+
+    uint64_t us = model->command_us + model->read_access_us;
+    us += (uint64_t)num_blocks * latency_bytes_us(model, LATENCY_BLOCK_FRAME_BYTES);
+    if (num_blocks > 1)
+    {
+        // CMD18 streams blocks back to back, then needs a CMD12
+        us += (uint64_t)(num_blocks - 1) * model->block_gap_us + model->command_us;
+    }
+
+    latency->stats.elapsed_us += us;
+    latency->stats.transfers++;
+    latency->stats.blocks_read += num_blocks;
+}
+
+static void latency_charge_write(blockdev_latency_t *latency, uint32_t num_blocks)
+{
+    const blockdev_latency_model_t *model = &latency->model;
+
+    // sd_write_blocks() issues one CMD24 per block
+    uint64_t per_block = model->command_us + latency_bytes_us(model, LATENCY_BLOCK_FRAME_BYTES) + model->write_busy_us;
+    latency->stats.elapsed_us += per_block * num_blocks;
+    latency->stats.transfers += num_blocks;
+    latency->stats.blocks_written += num_blocks;
+}
+
+static bool latency_present(void *context)
+{
+    blockdev_latency_t *latency = (blockdev_latency_t *)context;
+    return latency->inner->present(latency->inner->context);
+}
+
+static sd_error_t latency_init(void *context)
+{
+    blockdev_latency_t *latency = (blockdev_latency_t *)context;
+    return latency->inner->init(latency->inner->context);
+}
+
+static sd_error_t latency_read_blocks(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer)
+{
+    blockdev_latency_t *latency = (blockdev_latency_t *)context;
+    latency_charge_read(latency, num_blocks);
+    return latency->inner->read_blocks(latency->inner->context, start_block, num_blocks, buffer);
+}
+
+static sd_error_t latency_write_blocks(void *context, uint32_t start_block, uint32_t num_blocks, const uint8_t *buffer)
+{
+    blockdev_latency_t *latency = (blockdev_latency_t *)context;
+    latency_charge_write(latency, num_blocks);
+    return latency->inner->write_blocks(latency->inner->context, start_block, num_blocks, buffer);
+}
+
+// An asynchronous read occupies the bus just as long; it only overlaps with the caller.
+static sd_error_t latency_read_blocks_async(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer,
+                                            sd_async_callback_t callback, void *callback_context)
+{
+    blockdev_latency_t *latency = (blockdev_latency_t *)context;
+    latency_charge_read(latency, num_blocks);
+    return latency->inner->read_blocks_async(latency->inner->context, start_block, num_blocks, buffer,
+                                             callback, callback_context);
+}
+
+static bool latency_async_poll(void *context)
+{
+    blockdev_latency_t *latency = (blockdev_latency_t *)context;
+    return latency->inner->async_poll(latency->inner->context);
+}
+
+static void latency_async_wait(void *context)
+{
+    blockdev_latency_t *latency = (blockdev_latency_t *)context;
+    latency->inner->async_wait(latency->inner->context);
+}
+
+void blockdev_latency_default_model(blockdev_latency_model_t *model)
+{
+    model->spi_hz = SD_BAUDRATE;
+    model->command_us = 10;       // CS framing bytes, 6-byte command, R1 poll
+    model->read_access_us = 250;  // Typical SDHC read access in SPI mode
+    model->block_gap_us = 40;
+    model->write_busy_us = 1000;
+}
+
+const blockdev_t *blockdev_latency_init(blockdev_latency_t *latency, const blockdev_t *inner,
+                                        const blockdev_latency_model_t *model)
+{
+    memset(latency, 0, sizeof(*latency));
+    latency->inner = inner;
+    if (model)
+    {
+        latency->model = *model;
+    }
+    else
+    {
+        blockdev_latency_default_model(&latency->model);
+    }
+
+    latency->device.context = latency;
+    latency->device.present = latency_present;
+    latency->device.init = latency_init;
+    latency->device.read_blocks = latency_read_blocks;
+    latency->device.write_blocks = latency_write_blocks;
+    latency->device.read_blocks_async = latency_read_blocks_async;
+    latency->device.async_poll = latency_async_poll;
+    latency->device.async_wait = latency_async_wait;
+    return &latency->device;
+}
+
+void blockdev_latency_reset_stats(blockdev_latency_t *latency)
+{
+    memset(&latency->stats, 0, sizeof(latency->stats));
+}
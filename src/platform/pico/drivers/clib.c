@@ -3,6 +3,10 @@
 //
 // This file provides implementations for file operations using the FAT32 filesystem.
 //
+// newlib keeps a FILE* open across a card swap, so a descriptor whose handle went stale is
+// reopened on its next read or write (fat32_reopen) when the same file is back on the card.
+// Until then, and for good if the card or file changed, those calls fail with ENODEV.
+//
 // Include this file in your project to enable file handling capabilities.
 //
 
@@ -63,6 +67,8 @@ static int fat32_error_to_errno(fat32_error_t error)
         return ESPIPE;
     case FAT32_ERROR_INVALID_PARAMETER:
         return EINVAL;
+    case FAT32_ERROR_BUSY:
+        return EBUSY;
     default:
         return EIO; // General I/O error for unknown errors
     }
@@ -167,21 +173,33 @@ off_t _lseek(int fd, off_t offset, int whence)
     }
 
     fat32_file_t *file = &files[fd];
+    off_t position;
 
     if (whence == SEEK_SET)
     {
-        file->position = offset;
+        position = offset;
     }
     else if (whence == SEEK_CUR)
     {
-        file->position += offset;
+        position = (off_t)file->position + offset;
     }
     else if (whence == SEEK_END)
     {
-        file->position = file->file_size + offset;
+        position = (off_t)file->file_size + offset;
+    }
+    else
+    {
+        errno = EINVAL; // Invalid whence
+        return -1;
     }
 
-    if ((result = fat32_seek(file, offset)) == FAT32_OK)
+    if (position < 0)
+    {
+        errno = EINVAL; // Seek before the start of the file
+        return -1;
+    }
+
+    if ((result = fat32_seek(file, (uint32_t)position)) == FAT32_OK)
     {
         return file->position; // Success
     }
@@ -216,7 +234,12 @@ int _read(int fd, char *buffer, int length)
 
     fat32_file_t *file = &files[fd];
     size_t bytes_read = 0;
-    if ((result = fat32_read(file, buffer, length, &bytes_read)) != FAT32_OK)
+    result = fat32_read(file, buffer, length, &bytes_read);
+    if (result == FAT32_ERROR_NO_CARD && fat32_reopen(file) == FAT32_OK)
+    {
+        result = fat32_read(file, buffer, length, &bytes_read); // The card is back: retry on the reopened handle
+    }
+    if (result != FAT32_OK)
     {
         errno = fat32_error_to_errno(result);
         return -1; // Read failed
@@ -262,7 +285,12 @@ int _write(int fd, const char *buffer, int length)
 
     fat32_file_t *file = &files[fd];
     size_t bytes_written = 0;
-    if ((result = fat32_write(file, buffer, length, &bytes_written)) != FAT32_OK)
+    result = fat32_write(file, buffer, length, &bytes_written);
+    if (result == FAT32_ERROR_NO_CARD && fat32_reopen(file) == FAT32_OK)
+    {
+        result = fat32_write(file, buffer, length, &bytes_written); // The card is back: retry on the reopened handle
+    }
+    if (result != FAT32_OK)
     {
         errno = fat32_error_to_errno(result);
         return -1; // Write failed
@@ -14,11 +14,13 @@
 #include <ctype.h>
 #include <strings.h> // For strcasecmp
 
+#ifndef FAT32_HOST
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "pico/sem.h"
+#endif
 
-#include "sdcard.h"
+#include "blockdev.h"
 #include "fat32.h"
 
 #define RETURN_ON_ERROR(expr)        \
@@ -42,6 +44,7 @@
 
 // Global state
 static bool fat32_mounted = false;
+static uint32_t mount_generation = 0;           // Bumped by every mount; open files carry the one they were opened on
 static fat32_error_t mount_status = FAT32_OK; // Error code for mount operation
 bool fat32_initialised = false;               // Set to true after successful file system initialization
 
@@ -61,8 +64,115 @@ static uint32_t current_dir_cluster = 0; // Current directory cluster
 static uint8_t sector_buffer[FAT32_SECTOR_SIZE] __attribute__((aligned(4)));
 static fat32_lfn_entry_t lfn_buffer[MAX_LFN_PART]; // Buffer for long file name entries
 
+// Storage underneath the file system (the SD card unless fat32_set_blockdev() says otherwise)
+static const blockdev_t *blockdev = NULL;
+
+#ifndef FAT32_HOST
 // Timer for SD card detection
 static repeating_timer_t sd_card_detect_timer;
+#endif
+
+// Set by the card-detect timer interrupt; fat32_check_card() acts on it from the main thread
+static volatile bool card_removed = false;
+
+#if FAT32_CACHE_SECTORS > 0
+// Sector cache, keyed by volume-relative sector
+typedef struct
+{
+    uint8_t data[FAT32_SECTOR_SIZE] __attribute__((aligned(4)));
+    uint32_t sector;
+    uint32_t last_used; // LRU stamp from cache_clock
+    bool valid;
+} sector_cache_line_t;
+
+static sector_cache_line_t sector_cache[FAT32_CACHE_SECTORS];
+static uint32_t cache_clock = 0;
+#endif
+static fat32_cache_stats_t cache_stats;
+
+static fat32_extent_t extent_pool[FAT32_EXTENT_POOL];
+
+#if FAT32_PATH_CACHE_ENTRIES > 0
+// Path lookup cache: normalized path -> the directory entry fields fat32_open needs
+typedef struct
+{
+    bool valid;
+    uint32_t hash;
+    uint32_t base_cluster; // Directory the path was resolved from (root for absolute paths)
+    char path[FAT32_PATH_CACHE_MAX_LEN + 1];
+    uint32_t start_cluster;
+    uint32_t size;
+    uint32_t sector;
+    uint32_t offset;
+    uint8_t attr;
+} path_cache_entry_t;
+
+static path_cache_entry_t path_cache[FAT32_PATH_CACHE_ENTRIES];
+#endif
+
+// Asynchronous read state (one transfer at a time, like the SD driver underneath)
+static struct
+{
+    fat32_file_t *file;   // Owner of the transfer, NULL when idle
+    uint8_t *dest;        // Caller's buffer
+    uint32_t sector;      // First sector of the transfer
+    uint32_t sectors;
+    uint32_t byte_offset; // Offset of the requested data in async_buffer
+    size_t size;
+    volatile bool done;   // Set by the SD completion callback
+    sd_error_t result;
+    bool stale;           // A sector in the range was written while in flight
+} async_read;
+static uint8_t async_buffer[FAT32_ASYNC_MAX_SECTORS * FAT32_SECTOR_SIZE] __attribute__((aligned(4)));
+
+//
+//  Block device access
+//
+
+static inline bool device_present(void)
+{
+    return blockdev && blockdev->present(blockdev->context);
+}
+
+static inline sd_error_t device_init(void)
+{
+    return blockdev->init(blockdev->context);
+}
+
+static inline sd_error_t device_read(uint32_t block, uint32_t count, uint8_t *buffer)
+{
+    cache_stats.blocks_read += count;
+    return blockdev->read_blocks(blockdev->context, block, count, buffer);
+}
+
+static inline sd_error_t device_write(uint32_t block, uint32_t count, const uint8_t *buffer)
+{
+    cache_stats.blocks_written += count;
+    return blockdev->write_blocks(blockdev->context, block, count, buffer);
+}
+
+static inline sd_error_t device_read_async(uint32_t block, uint32_t count, uint8_t *buffer,
+                                           sd_async_callback_t callback, void *context)
+{
+    cache_stats.blocks_read += count;
+    return blockdev->read_blocks_async(blockdev->context, block, count, buffer, callback, context);
+}
+
+static inline void device_async_poll(void)
+{
+    if (blockdev)
+    {
+        blockdev->async_poll(blockdev->context);
+    }
+}
+
+static inline void device_async_wait(void)
+{
+    if (blockdev)
+    {
+        blockdev->async_wait(blockdev->context);
+    }
+}
 
 //
 //  Sector-level access functions
@@ -73,14 +183,210 @@ static inline uint32_t cluster_to_sector(uint32_t cluster)
     return ((cluster - 2) * boot_sector.sectors_per_cluster) + first_data_sector;
 }
 
+#if FAT32_CACHE_SECTORS > 0
+static sector_cache_line_t *cache_lookup(uint32_t sector)
+{
+    for (int i = 0; i < FAT32_CACHE_SECTORS; i++)
+    {
+        if (sector_cache[i].valid && sector_cache[i].sector == sector)
+        {
+            sector_cache[i].last_used = ++cache_clock;
+            return &sector_cache[i];
+        }
+    }
+    return NULL;
+}
+
+static sector_cache_line_t *cache_victim(void)
+{
+    sector_cache_line_t *victim = &sector_cache[0];
+    for (int i = 0; i < FAT32_CACHE_SECTORS; i++)
+    {
+        if (!sector_cache[i].valid)
+        {
+            return &sector_cache[i];
+        }
+        if (sector_cache[i].last_used < victim->last_used)
+        {
+            victim = &sector_cache[i];
+        }
+    }
+    return victim;
+}
+
+static void cache_store(uint32_t sector, const uint8_t *buffer)
+{
+    sector_cache_line_t *line = cache_lookup(sector);
+    if (!line)
+    {
+        line = cache_victim();
+        line->sector = sector;
+        line->valid = true;
+        line->last_used = ++cache_clock;
+    }
+    memcpy(line->data, buffer, FAT32_SECTOR_SIZE);
+}
+#endif
+
+static void cache_invalidate(void)
+{
+#if FAT32_CACHE_SECTORS > 0
+    for (int i = 0; i < FAT32_CACHE_SECTORS; i++)
+    {
+        sector_cache[i].valid = false;
+    }
+    cache_clock = 0;
+#endif
+}
+
+//
+//  Path lookup cache
+//
+
+static void path_cache_invalidate(void)
+{
+#if FAT32_PATH_CACHE_ENTRIES > 0
+    for (int i = 0; i < FAT32_PATH_CACHE_ENTRIES; i++)
+    {
+        path_cache[i].valid = false;
+    }
+#endif
+}
+
+#if FAT32_PATH_CACHE_ENTRIES > 0
+// Lowercase (FAT names are case-insensitive) and drop empty components, so "/LEVELS//l02.bin"
+// and "/levels/L02.BIN" share a key. Returns the slot, or NULL if the path is not cacheable.
+static path_cache_entry_t *path_cache_key(const char *path, char *key, uint32_t *base_cluster, uint32_t *hash)
+{
+    *base_cluster = (path[0] == '/') ? boot_sector.root_cluster : current_dir_cluster;
+
+    size_t len = 0;
+    for (const char *p = path; *p; p++)
+    {
+        if (*p == '/' && (len == 0 || key[len - 1] == '/'))
+        {
+            continue;
+        }
+        if (len >= FAT32_PATH_CACHE_MAX_LEN)
+        {
+            return NULL;
+        }
+        key[len++] = (char)tolower((unsigned char)*p);
+    }
+    if (len > 0 && key[len - 1] == '/')
+    {
+        len--;
+    }
+    key[len] = '\0';
+
+    if (len == 0 || strcmp(key, ".") == 0 || strcmp(key, "..") == 0)
+    {
+        return NULL; // find_entry answers these without a directory scan
+    }
+
+    // FNV-1a over the key, mixed with the base directory
+    uint32_t h = 2166136261u ^ *base_cluster;
+    for (size_t i = 0; i < len; i++)
+    {
+        h = (h ^ (uint8_t)key[i]) * 16777619u;
+    }
+    *hash = h;
+    return &path_cache[h % FAT32_PATH_CACHE_ENTRIES];
+}
+#endif
+
+static bool path_cache_get(const char *path, fat32_entry_t *entry)
+{
+#if FAT32_PATH_CACHE_ENTRIES > 0
+    char key[FAT32_PATH_CACHE_MAX_LEN + 1];
+    uint32_t base_cluster, hash;
+    path_cache_entry_t *slot = path_cache_key(path, key, &base_cluster, &hash);
+    if (slot && slot->valid && slot->hash == hash && slot->base_cluster == base_cluster && strcmp(slot->path, key) == 0)
+    {
+        entry->start_cluster = slot->start_cluster;
+        entry->size = slot->size;
+        entry->sector = slot->sector;
+        entry->offset = slot->offset;
+        entry->attr = slot->attr;
+        cache_stats.path_hits++;
+        return true;
+    }
+#endif
+    cache_stats.path_misses++;
+    return false;
+}
+
+static void path_cache_put(const char *path, const fat32_entry_t *entry)
+{
+#if FAT32_PATH_CACHE_ENTRIES > 0
+    char key[FAT32_PATH_CACHE_MAX_LEN + 1];
+    uint32_t base_cluster, hash;
+    path_cache_entry_t *slot = path_cache_key(path, key, &base_cluster, &hash);
+    if (!slot)
+    {
+        return;
+    }
+
+    slot->valid = true;
+    slot->hash = hash;
+    slot->base_cluster = base_cluster;
+    strcpy(slot->path, key);
+    slot->start_cluster = entry->start_cluster;
+    slot->size = entry->size;
+    slot->sector = entry->sector;
+    slot->offset = entry->offset;
+    slot->attr = entry->attr;
+#else
+    (void)path;
+    (void)entry;
+#endif
+}
+
 static inline fat32_error_t read_sector(uint32_t sector, uint8_t *buffer)
 {
-    return sd_read_block(volume_start_block + sector, buffer);
+#if FAT32_CACHE_SECTORS > 0
+    sector_cache_line_t *line = cache_lookup(sector);
+    if (line)
+    {
+        cache_stats.hits++;
+        memcpy(buffer, line->data, FAT32_SECTOR_SIZE);
+        return FAT32_OK;
+    }
+#endif
+
+    cache_stats.misses++;
+    sd_error_t result = device_read(volume_start_block + sector, 1, buffer);
+#if FAT32_CACHE_SECTORS > 0
+    if (result == SD_OK)
+    {
+        cache_store(sector, buffer);
+    }
+#endif
+    return result;
+}
+
+// Multi-sector read straight into the caller's buffer (bypasses the cache; the
+// cache is write-through so the card always holds the current data)
+static inline fat32_error_t read_sectors(uint32_t sector, uint32_t count, uint8_t *buffer)
+{
+    return device_read(volume_start_block + sector, count, buffer);
 }
 
 static inline fat32_error_t write_sector(uint32_t sector, const uint8_t *buffer)
 {
-    return sd_write_block(volume_start_block + sector, buffer);
+    // Write-through: the card is always current, the cache only mirrors it
+    sd_error_t result = device_write(volume_start_block + sector, 1, buffer);
+#if FAT32_CACHE_SECTORS > 0
+    if (result == SD_OK)
+    {
+        cache_store(sector, buffer);
+    }
+#endif
+    if (async_read.file && sector >= async_read.sector && sector < async_read.sector + async_read.sectors)
+    {
+        async_read.stale = true;
+    }
+    return result;
 }
 
 //
@@ -191,6 +497,7 @@ static fat32_error_t read_cluster_fat_entry(uint32_t cluster, uint32_t *value)
     uint32_t entry_offset = fat_offset % FAT32_SECTOR_SIZE;
 
     // Read the FAT sector
+    cache_stats.fat_reads++;
     RETURN_ON_ERROR(read_sector(fat_sector, sector_buffer));
 
     uint32_t entry = *(uint32_t *)(sector_buffer + entry_offset);
@@ -334,13 +641,270 @@ static fat32_error_t seek_to_cluster(uint32_t start_cluster, uint32_t offset, ui
     return FAT32_OK;
 }
 
+// Count how many clusters follow start_cluster contiguously, up to max_clusters.
+// A contiguous chain has consecutive FAT entries, so each FAT sector is read only once.
+static fat32_error_t scan_contiguous_run(uint32_t start_cluster, uint32_t max_clusters, uint32_t *run_length)
+{
+    uint32_t cluster = start_cluster;
+    uint32_t count = 1;
+    uint32_t loaded_sector = 0xFFFFFFFF;
+
+    while (count < max_clusters)
+    {
+        uint32_t fat_offset = cluster * 4;
+        uint32_t fat_sector = boot_sector.reserved_sectors + (fat_offset / FAT32_SECTOR_SIZE);
+        if (fat_sector != loaded_sector)
+        {
+            RETURN_ON_ERROR(read_sector(fat_sector, sector_buffer));
+            loaded_sector = fat_sector;
+        }
+
+        cache_stats.fat_reads++;
+        uint32_t next_cluster = *(uint32_t *)(sector_buffer + (fat_offset % FAT32_SECTOR_SIZE)) & 0x0FFFFFFF;
+        if (next_cluster != cluster + 1)
+        {
+            break;
+        }
+        cluster = next_cluster;
+        count++;
+    }
+
+    *run_length = count;
+    return FAT32_OK;
+}
+
+// Map the contiguous prefix of a regular file's chain so seeks inside it never walk the FAT.
+// Runs once per open, on the first access past cluster 0; files that fit one cluster and
+// files only read near the start never pay for it.
+static fat32_error_t find_contiguous_prefix(fat32_file_t *file)
+{
+    if (file->contiguous_clusters > 0 || file->extent_count > 0 || file->start_cluster < 2 ||
+        file->file_size <= bytes_per_cluster)
+    {
+        return FAT32_OK;
+    }
+
+    uint32_t file_clusters = (file->file_size + bytes_per_cluster - 1) / bytes_per_cluster;
+    return scan_contiguous_run(file->start_cluster, file_clusters, &file->contiguous_clusters);
+}
+
+// Find the extent of a pinned file that holds chain index `index`.
+// *base receives the chain index of the extent's first cluster.
+static const fat32_extent_t *pinned_extent(const fat32_file_t *file, uint32_t index, uint32_t *base)
+{
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < file->extent_count; i++)
+    {
+        const fat32_extent_t *extent = &extent_pool[file->extent_first + i];
+        if (index < first + extent->length)
+        {
+            *base = first;
+            return extent;
+        }
+        first += extent->length;
+    }
+    return NULL;
+}
+
+// Walk the chain once and store it as extents in a free span of the pool.
+// Leaves the file unpinned if the chain does not fit.
+static fat32_error_t pin_cluster_chain(fat32_file_t *file, uint32_t file_clusters)
+{
+    fat32_extent_t map[FAT32_EXTENT_POOL];
+    uint32_t count = 1;
+    uint32_t loaded_sector = 0xFFFFFFFF;
+
+    // If a read already mapped the contiguous prefix, carry on from its last cluster
+    uint32_t prefix = file->contiguous_clusters ? file->contiguous_clusters : 1;
+    uint32_t cluster = file->start_cluster + prefix - 1;
+    map[0].start_cluster = file->start_cluster;
+    map[0].length = prefix;
+
+    for (uint32_t i = prefix; i < file_clusters; i++)
+    {
+        uint32_t fat_offset = cluster * 4;
+        uint32_t fat_sector = boot_sector.reserved_sectors + (fat_offset / FAT32_SECTOR_SIZE);
+        if (fat_sector != loaded_sector)
+        {
+            RETURN_ON_ERROR(read_sector(fat_sector, sector_buffer));
+            loaded_sector = fat_sector;
+        }
+
+        cache_stats.fat_reads++;
+        uint32_t next_cluster = *(uint32_t *)(sector_buffer + (fat_offset % FAT32_SECTOR_SIZE)) & 0x0FFFFFFF;
+        if (next_cluster < 2 || next_cluster >= FAT32_FAT_ENTRY_EOC)
+        {
+            return FAT32_ERROR_INVALID_POSITION; // Chain shorter than the file size says
+        }
+
+        if (next_cluster == cluster + 1)
+        {
+            map[count - 1].length++;
+        }
+        else
+        {
+            if (count == FAT32_EXTENT_POOL)
+            {
+                return FAT32_OK; // Too fragmented to pin
+            }
+            map[count].start_cluster = next_cluster;
+            map[count].length = 1;
+            count++;
+        }
+        cluster = next_cluster;
+    }
+
+    // First fit: a run of free slots long enough for the whole map
+    uint32_t run = 0;
+    for (uint32_t slot = 0; slot < FAT32_EXTENT_POOL; slot++)
+    {
+        run = extent_pool[slot].length ? 0 : run + 1;
+        if (run == count)
+        {
+            uint32_t first = slot + 1 - count;
+            memcpy(&extent_pool[first], map, count * sizeof(fat32_extent_t));
+            file->extent_first = (uint16_t)first;
+            file->extent_count = (uint16_t)count;
+            return FAT32_OK;
+        }
+    }
+    return FAT32_OK; // Pool full
+}
+
+static void unpin_cluster_chain(fat32_file_t *file)
+{
+    for (uint32_t i = 0; i < file->extent_count; i++)
+    {
+        extent_pool[file->extent_first + i].length = 0;
+    }
+    file->extent_first = 0;
+    file->extent_count = 0;
+}
+
+// Resolve the cluster holding chain index `index` of an open file.
+// Pinned files and indexes inside the contiguous run are pure arithmetic; anything else
+// walks the FAT forward from the nearest known point (end of run or the last resolved hint).
+static fat32_error_t file_cluster_at(fat32_file_t *file, uint32_t index, uint32_t *result_cluster)
+{
+    if (file->extent_count > 0)
+    {
+        uint32_t base;
+        const fat32_extent_t *extent = pinned_extent(file, index, &base);
+        if (!extent)
+        {
+            return FAT32_ERROR_INVALID_POSITION;
+        }
+        *result_cluster = extent->start_cluster + (index - base);
+        return FAT32_OK;
+    }
+
+    if (index > 0)
+    {
+        RETURN_ON_ERROR(find_contiguous_prefix(file));
+    }
+    if (index < file->contiguous_clusters)
+    {
+        *result_cluster = file->start_cluster + index;
+        return FAT32_OK;
+    }
+
+    uint32_t from_index = 0;
+    uint32_t from_cluster = file->start_cluster;
+    if (file->contiguous_clusters > 0)
+    {
+        from_index = file->contiguous_clusters - 1;
+        from_cluster = file->start_cluster + from_index;
+    }
+    if (file->hint_cluster >= 2 && file->hint_cluster_index <= index && file->hint_cluster_index > from_index)
+    {
+        from_index = file->hint_cluster_index;
+        from_cluster = file->hint_cluster;
+    }
+
+    RETURN_ON_ERROR(seek_to_cluster(from_cluster, index - from_index, result_cluster));
+
+    file->hint_cluster_index = index;
+    file->hint_cluster = *result_cluster;
+    return FAT32_OK;
+}
+
+// Clamp *sectors to the run that starts at sector_in_cluster of file->current_cluster and
+// continues through clusters that follow it directly on disk. Clusters inside the file's
+// contiguous prefix or current extent are known without I/O; past it each step checks one
+// FAT entry.
+static fat32_error_t contiguous_sectors(fat32_file_t *file, uint32_t sector_in_cluster, uint32_t *sectors)
+{
+    uint32_t run_sectors = boot_sector.sectors_per_cluster - sector_in_cluster;
+    uint32_t cluster_index = file->position / bytes_per_cluster;
+    uint32_t cluster = file->current_cluster;
+
+    // Extents are maximal runs, so a pinned run ends with its extent
+    uint32_t pinned_end = 0;
+    if (file->extent_count > 0)
+    {
+        uint32_t base;
+        const fat32_extent_t *extent = pinned_extent(file, cluster_index, &base);
+        pinned_end = extent ? base + extent->length : 0;
+    }
+    else if (run_sectors < *sectors)
+    {
+        RETURN_ON_ERROR(find_contiguous_prefix(file));
+    }
+
+    while (run_sectors < *sectors)
+    {
+        cluster_index++;
+        if (file->extent_count > 0)
+        {
+            if (cluster_index >= pinned_end)
+            {
+                break;
+            }
+        }
+        else if (cluster_index >= file->contiguous_clusters)
+        {
+            uint32_t next_cluster;
+            RETURN_ON_ERROR(read_cluster_fat_entry(cluster, &next_cluster));
+            if (next_cluster != cluster + 1)
+            {
+                break;
+            }
+        }
+        cluster++;
+        run_sectors += boot_sector.sectors_per_cluster;
+    }
+
+    if (*sectors > run_sectors)
+    {
+        *sectors = run_sectors;
+    }
+    return FAT32_OK;
+}
+
+static inline void reset_cluster_hints(fat32_file_t *file)
+{
+    unpin_cluster_chain(file);
+    file->contiguous_clusters = 0;
+    file->hint_cluster_index = 0;
+    file->hint_cluster = 0;
+}
+
+// A handle opened before the card was removed must not touch whatever is mounted now,
+// and must not remount it either: the caller decides when to pay for that. A removal the
+// card-detect timer flagged is handled first, so it is never missed here.
+static inline bool file_is_current(const fat32_file_t *file)
+{
+    fat32_check_card();
+    return fat32_mounted && file->mount_generation == mount_generation;
+}
+
 //
 // Mount the SD Card functions
 //
 
 fat32_error_t fat32_mount(void)
 {
-    if (!sd_card_present())
+    if (!device_present())
     {
         fat32_unmount(); // Unmount if card is not present
         return FAT32_ERROR_NO_CARD;
@@ -351,10 +915,14 @@ fat32_error_t fat32_mount(void)
         return FAT32_OK;
     }
 
-    RETURN_ON_ERROR(sd_card_init());
+    RETURN_ON_ERROR(device_init());
+
+    // The card may have changed since the last mount
+    cache_invalidate();
+    path_cache_invalidate();
 
     // Read boot sector
-    RETURN_ON_ERROR(sd_read_block(0, sector_buffer));
+    RETURN_ON_ERROR(device_read(0, 1, sector_buffer));
 
     // Is this a Master Boot Record (MBR)?
     if (is_sector_mbr(sector_buffer))
@@ -379,7 +947,7 @@ fat32_error_t fat32_mount(void)
                 volume_start_block = partition_entry->start_lba;
 
                 // Read the boot sector from the partition
-                RETURN_ON_ERROR(sd_read_block(volume_start_block, sector_buffer));
+                RETURN_ON_ERROR(device_read(volume_start_block, 1, sector_buffer));
                 break;
             }
         }
@@ -431,6 +999,7 @@ fat32_error_t fat32_mount(void)
 
     fat32_mounted = true;
     mount_status = FAT32_OK;
+    mount_generation++;
     return FAT32_OK;
 }
 
@@ -444,6 +1013,9 @@ void fat32_unmount(void)
     cluster_count = 0;
     bytes_per_cluster = 0;
     current_dir_cluster = 0;
+    cache_invalidate();
+    path_cache_invalidate();
+    async_read.file = NULL;
 }
 
 bool fat32_is_mounted(void)
@@ -451,22 +1023,29 @@ bool fat32_is_mounted(void)
     return fat32_mounted;
 }
 
-bool fat32_is_ready(void)
+void fat32_check_card(void)
 {
-    if (sd_card_present())
+    // A card the timer saw removed may be back already, but everything cached came from
+    // the card that was pulled: unmount either way, the next fat32_is_ready() remounts.
+    bool removed = card_removed || !device_present();
+    card_removed = false;
+    if (!removed)
     {
-        if (!fat32_mounted)
-        {
-            mount_status = fat32_mount();
-        }
+        return;
     }
-    else
+    if (fat32_mounted)
     {
-        if (fat32_mounted)
-        {
-            fat32_unmount(); // Unmount if card is not present
-        }
-        mount_status = FAT32_ERROR_NO_CARD; // Set status to no card present
+        fat32_unmount();
+    }
+    mount_status = FAT32_ERROR_NO_CARD;
+}
+
+bool fat32_is_ready(void)
+{
+    fat32_check_card();
+    if (device_present() && !fat32_mounted)
+    {
+        mount_status = fat32_mount();
     }
     return mount_status == FAT32_OK;
 }
@@ -537,6 +1116,19 @@ uint32_t fat32_get_cluster_size(void)
     return boot_sector.sectors_per_cluster * FAT32_SECTOR_SIZE;
 }
 
+void fat32_get_cache_stats(fat32_cache_stats_t *stats)
+{
+    if (stats)
+    {
+        *stats = cache_stats;
+    }
+}
+
+void fat32_reset_cache_stats(void)
+{
+    memset(&cache_stats, 0, sizeof(cache_stats));
+}
+
 fat32_error_t fat32_get_volume_name(char *name, size_t name_len)
 {
     if (!name || name_len < 12)
@@ -1020,6 +1612,8 @@ static fat32_error_t unlink_entry(fat32_entry_t *entry)
         return FAT32_ERROR_INVALID_PARAMETER;
     }
 
+    path_cache_invalidate(); // Delete and rename change what paths resolve to
+
     // Mark the entry as deleted
     uint32_t sector = entry->sector;
     uint32_t offset = entry->offset;
@@ -1078,6 +1672,8 @@ static fat32_error_t link_entry(fat32_entry_t *entry, const char *path)
         return result;
     }
 
+    path_cache_invalidate(); // Create and rename add entries (and may move existing ones)
+
     // Split path into parent and filename
     char path_copy[FAT32_MAX_PATH_LEN];
     strncpy(path_copy, path, sizeof(path_copy) - 1);
@@ -1281,6 +1877,7 @@ static fat32_error_t new_entry(fat32_file_t *file, const char *path, uint8_t att
     RETURN_ON_ERROR(link_entry(&entry, path));
 
     file->is_open = true;
+    file->mount_generation = mount_generation;
     file->start_cluster = entry.start_cluster;
     file->current_cluster = file->start_cluster;
     file->attributes = entry.attr;
@@ -1348,7 +1945,11 @@ fat32_error_t fat32_open(fat32_file_t *file, const char *path)
     memset(file, 0, sizeof(fat32_file_t));
 
     fat32_entry_t entry;
-    RETURN_ON_ERROR(find_entry(&entry, path));
+    if (!path_cache_get(path, &entry))
+    {
+        RETURN_ON_ERROR(find_entry(&entry, path));
+        path_cache_put(path, &entry);
+    }
 
     if (entry.attr & FAT32_ATTR_VOLUME_ID)
     {
@@ -1366,12 +1967,83 @@ fat32_error_t fat32_open(fat32_file_t *file, const char *path)
         file->file_size = entry.size;
     }
     file->is_open = true;
+    file->mount_generation = mount_generation;
     file->current_cluster = file->start_cluster;
     file->position = 0;
     file->attributes = entry.attr;
     file->dir_entry_sector = entry.sector;
     file->dir_entry_offset = entry.offset;
 
+    // The contiguous prefix of the chain is mapped by the first access past cluster 0
+    // (see find_contiguous_prefix), so opening costs the same whatever the file size.
+    return FAT32_OK;
+}
+
+fat32_error_t fat32_open_pinned(fat32_file_t *file, const char *path)
+{
+    RETURN_ON_ERROR(fat32_open(file, path));
+
+    if (!(file->attributes & FAT32_ATTR_DIRECTORY) && file->start_cluster >= 2 && file->file_size > 0)
+    {
+        uint32_t file_clusters = (file->file_size + bytes_per_cluster - 1) / bytes_per_cluster;
+        fat32_error_t result = pin_cluster_chain(file, file_clusters);
+        if (result != FAT32_OK)
+        {
+            fat32_close(file);
+            return result;
+        }
+    }
+    return FAT32_OK;
+}
+
+bool fat32_is_pinned(const fat32_file_t *file)
+{
+    return file && file->extent_count > 0;
+}
+
+fat32_error_t fat32_reopen(fat32_file_t *file)
+{
+    if (!file || !file->is_open)
+    {
+        return FAT32_ERROR_INVALID_PARAMETER;
+    }
+
+    if (file_is_current(file))
+    {
+        return FAT32_OK;
+    }
+
+    if (!fat32_is_ready())
+    {
+        return mount_status;
+    }
+
+    // Only the same file takes the handle back: its directory entry must still be where it
+    // was and name the same first cluster, size and attributes. Anything else (another card,
+    // or the file was changed elsewhere) has to be opened again by path.
+    if (file->dir_entry_sector == 0 || file->dir_entry_offset > FAT32_SECTOR_SIZE - sizeof(fat32_dir_entry_t))
+    {
+        return FAT32_ERROR_FILE_NOT_FOUND;
+    }
+    RETURN_ON_ERROR(read_sector(file->dir_entry_sector, sector_buffer));
+    const fat32_dir_entry_t *entry = (const fat32_dir_entry_t *)(sector_buffer + file->dir_entry_offset);
+    uint32_t start_cluster = ((uint32_t)entry->fst_clus_hi << 16) | entry->fst_clus_lo;
+    if ((uint8_t)entry->shortname[0] == 0x00 || (uint8_t)entry->shortname[0] == 0xE5 ||
+        entry->attr != file->attributes || start_cluster != file->start_cluster || entry->file_size != file->file_size)
+    {
+        return FAT32_ERROR_FILE_NOT_FOUND;
+    }
+
+    // The position carries over; chain hints are found again on use, pinned extents now
+    bool pinned = file->extent_count > 0;
+    reset_cluster_hints(file);
+    file->mount_generation = mount_generation;
+    file->current_cluster = file->start_cluster;
+    if (pinned)
+    {
+        uint32_t file_clusters = (file->file_size + bytes_per_cluster - 1) / bytes_per_cluster;
+        RETURN_ON_ERROR(pin_cluster_chain(file, file_clusters));
+    }
     return FAT32_OK;
 }
 
@@ -1384,6 +2056,11 @@ fat32_error_t fat32_close(fat32_file_t *file)
 {
     if (file && file->is_open)
     {
+        if (async_read.file == file)
+        {
+            async_read.file = NULL; // Drop the pending read; it only targets async_buffer
+        }
+        unpin_cluster_chain(file);
         memset(file, 0, sizeof(fat32_file_t));
     }
 
@@ -1402,6 +2079,11 @@ fat32_error_t fat32_read(fat32_file_t *file, void *buffer, size_t size, size_t *
         return FAT32_ERROR_NOT_A_FILE; // Cannot read from a directory
     }
 
+    if (!file_is_current(file))
+    {
+        return FAT32_ERROR_NO_CARD; // Opened before the card went away; reopen it
+    }
+
     if (!fat32_is_ready())
     {
         return mount_status;
@@ -1426,7 +2108,7 @@ fat32_error_t fat32_read(fat32_file_t *file, void *buffer, size_t size, size_t *
     // Ensure current_cluster is correct for current file position
     uint32_t cluster = 0;
     uint32_t cluster_offset = file->position / bytes_per_cluster;
-    RETURN_ON_ERROR(seek_to_cluster(file->start_cluster, cluster_offset, &cluster));
+    RETURN_ON_ERROR(file_cluster_at(file, cluster_offset, &cluster));
     file->current_cluster = cluster;
 
     size_t total_read = 0;
@@ -1440,15 +2122,42 @@ fat32_error_t fat32_read(fat32_file_t *file, void *buffer, size_t size, size_t *
 
         uint32_t sector = cluster_to_sector(file->current_cluster) + sector_in_cluster;
 
-        RETURN_ON_ERROR(read_sector(sector, sector_buffer));
-
-        size_t bytes_to_copy = FAT32_SECTOR_SIZE - byte_in_sector;
-        if (bytes_to_copy > size - total_read)
+        size_t bytes_to_copy;
+        uint32_t whole_sectors = (size - total_read) / FAT32_SECTOR_SIZE;
+        if (byte_in_sector == 0 && whole_sectors > 0)
+        {
+            // Sector-aligned: stream whole sectors straight into the caller's buffer with one
+            // multi-block read, extended over every following cluster that lies next on disk
+            RETURN_ON_ERROR(contiguous_sectors(file, sector_in_cluster, &whole_sectors));
+            RETURN_ON_ERROR(read_sectors(sector, whole_sectors, dest + total_read));
+            bytes_to_copy = whole_sectors * FAT32_SECTOR_SIZE;
+
+            // Leave current_cluster on the last cluster the run touched
+            uint32_t clusters_crossed = (sector_in_cluster + whole_sectors - 1) / boot_sector.sectors_per_cluster;
+            if (clusters_crossed > 0)
+            {
+                file->current_cluster += clusters_crossed;
+                uint32_t cluster_index = file->position / bytes_per_cluster + clusters_crossed;
+                if (cluster_index >= file->contiguous_clusters)
+                {
+                    file->hint_cluster_index = cluster_index;
+                    file->hint_cluster = file->current_cluster;
+                }
+            }
+        }
+        else
         {
-            bytes_to_copy = size - total_read;
+            RETURN_ON_ERROR(read_sector(sector, sector_buffer));
+
+            bytes_to_copy = FAT32_SECTOR_SIZE - byte_in_sector;
+            if (bytes_to_copy > size - total_read)
+            {
+                bytes_to_copy = size - total_read;
+            }
+
+            memcpy(dest + total_read, sector_buffer + byte_in_sector, bytes_to_copy);
         }
 
-        memcpy(dest + total_read, sector_buffer + byte_in_sector, bytes_to_copy);
         total_read += bytes_to_copy;
         file->position += bytes_to_copy;
 
@@ -1456,16 +2165,18 @@ fat32_error_t fat32_read(fat32_file_t *file, void *buffer, size_t size, size_t *
         if ((file->position % bytes_per_cluster) == 0 && total_read < size)
         {
             uint32_t next_cluster;
-            RETURN_ON_ERROR(read_cluster_fat_entry(file->current_cluster, &next_cluster));
-            if (next_cluster >= FAT32_FAT_ENTRY_EOC)
+            fat32_error_t result = file_cluster_at(file, file->position / bytes_per_cluster, &next_cluster);
+            if (result == FAT32_ERROR_INVALID_POSITION)
             {
-                // End of cluster chain or error
+                // End of cluster chain
                 break;
             }
+            RETURN_ON_ERROR(result);
             file->current_cluster = next_cluster;
         }
     }
 
+    cache_stats.bytes_read += total_read;
     if (bytes_read)
     {
         *bytes_read = total_read;
@@ -1473,6 +2184,173 @@ fat32_error_t fat32_read(fat32_file_t *file, void *buffer, size_t size, size_t *
     return FAT32_OK;
 }
 
+static void on_async_read_done(sd_error_t result, void *context)
+{
+    (void)context;
+    async_read.result = result;
+    async_read.done = true;
+}
+
+fat32_error_t fat32_read_async(fat32_file_t *file, void *buffer, size_t size, bool *done, size_t *bytes_read)
+{
+    if (!file || !file->is_open || !buffer || !done)
+    {
+        return FAT32_ERROR_INVALID_PARAMETER;
+    }
+
+    if (file->attributes & FAT32_ATTR_DIRECTORY)
+    {
+        return FAT32_ERROR_NOT_A_FILE; // Cannot read from a directory
+    }
+
+    if (!file_is_current(file))
+    {
+        return FAT32_ERROR_NO_CARD; // Opened before the card went away; reopen it
+    }
+
+    if (!fat32_is_ready())
+    {
+        return mount_status;
+    }
+
+    if (async_read.file)
+    {
+        return FAT32_ERROR_BUSY;
+    }
+
+    *done = true;
+    if (bytes_read)
+    {
+        *bytes_read = 0;
+    }
+
+    if (file->position >= file->file_size)
+    {
+        return FAT32_OK; // EOF
+    }
+
+    size_t remaining = file->file_size - file->position;
+    if (size > remaining)
+    {
+        size = remaining;
+    }
+
+    uint32_t cluster = 0;
+    RETURN_ON_ERROR(file_cluster_at(file, file->position / bytes_per_cluster, &cluster));
+    file->current_cluster = cluster;
+
+    uint32_t cluster_offset = file->position % bytes_per_cluster;
+    uint32_t sector_in_cluster = cluster_offset / FAT32_SECTOR_SIZE;
+    uint32_t byte_in_sector = cluster_offset % FAT32_SECTOR_SIZE;
+    uint32_t sector = cluster_to_sector(cluster) + sector_in_cluster;
+
+#if FAT32_CACHE_SECTORS > 0
+    if (cache_lookup(sector))
+    {
+        // Already cached: finish synchronously without touching the card
+        if (size > FAT32_SECTOR_SIZE - byte_in_sector)
+        {
+            size = FAT32_SECTOR_SIZE - byte_in_sector;
+        }
+        return fat32_read(file, buffer, size, bytes_read);
+    }
+#endif
+
+    uint32_t sectors = (byte_in_sector + size + FAT32_SECTOR_SIZE - 1) / FAT32_SECTOR_SIZE;
+    uint32_t sectors_left = boot_sector.sectors_per_cluster - sector_in_cluster;
+    if (sectors > sectors_left)
+    {
+        sectors = sectors_left;
+    }
+    if (sectors > FAT32_ASYNC_MAX_SECTORS)
+    {
+        sectors = FAT32_ASYNC_MAX_SECTORS;
+    }
+    if (byte_in_sector + size > sectors * FAT32_SECTOR_SIZE)
+    {
+        size = sectors * FAT32_SECTOR_SIZE - byte_in_sector;
+    }
+
+    device_async_wait(); // Retire a transfer dropped by fat32_close() before reusing the state
+
+    async_read.file = file;
+    async_read.dest = (uint8_t *)buffer;
+    async_read.sector = sector;
+    async_read.sectors = sectors;
+    async_read.byte_offset = byte_in_sector;
+    async_read.size = size;
+    async_read.done = false;
+    async_read.result = SD_OK;
+    async_read.stale = false;
+
+    if (device_read_async(volume_start_block + sector, sectors, async_buffer, on_async_read_done, NULL) != SD_OK)
+    {
+        async_read.file = NULL;
+        return FAT32_ERROR_READ_FAILED;
+    }
+
+    *done = false;
+    return FAT32_OK;
+}
+
+fat32_error_t fat32_read_async_poll(fat32_file_t *file, bool *done, size_t *bytes_read)
+{
+    if (!file || !done)
+    {
+        return FAT32_ERROR_INVALID_PARAMETER;
+    }
+
+    *done = true;
+    if (bytes_read)
+    {
+        *bytes_read = 0;
+    }
+
+    if (async_read.file != file)
+    {
+        return FAT32_OK; // Nothing in flight for this file
+    }
+
+    device_async_poll();
+    if (!async_read.done)
+    {
+        *done = false;
+        return FAT32_OK;
+    }
+
+    async_read.file = NULL;
+    if (!file_is_current(file))
+    {
+        return FAT32_ERROR_NO_CARD; // The card went away mid-transfer; the data is not trusted
+    }
+    if (async_read.result != SD_OK)
+    {
+        return FAT32_ERROR_READ_FAILED;
+    }
+
+    if (async_read.stale)
+    {
+        // The range was rewritten mid-transfer; the cache holds the current data
+        return fat32_read(file, async_read.dest, async_read.size, bytes_read);
+    }
+
+#if FAT32_CACHE_SECTORS > 0
+    for (uint32_t i = 0; i < async_read.sectors; i++)
+    {
+        cache_store(async_read.sector + i, async_buffer + i * FAT32_SECTOR_SIZE);
+    }
+#endif
+
+    memcpy(async_read.dest, async_buffer + async_read.byte_offset, async_read.size);
+    file->position += async_read.size;
+    cache_stats.bytes_read += async_read.size;
+    if (bytes_read)
+    {
+        *bytes_read = async_read.size;
+    }
+    return FAT32_OK;
+}
+
 fat32_error_t fat32_write(fat32_file_t *file, const void *buffer, size_t size, size_t *bytes_written)
 {
     if (!file || !file->is_open || !buffer)
@@ -1485,6 +2363,11 @@ fat32_error_t fat32_write(fat32_file_t *file, const void *buffer, size_t size, s
         return FAT32_ERROR_NOT_A_FILE; // Cannot write to a directory
     }
 
+    if (!file_is_current(file))
+    {
+        return FAT32_ERROR_NO_CARD; // Opened before the card went away; reopen it
+    }
+
     if (!fat32_is_ready())
     {
         return mount_status;
@@ -1497,6 +2380,9 @@ fat32_error_t fat32_write(fat32_file_t *file, const void *buffer, size_t size, s
 
     uint32_t old_file_size = file->file_size;
 
+    // Writes can allocate, truncate or replace the chain; drop any cached chain positions
+    reset_cluster_hints(file);
+
     // Ensure current_cluster is correct for current file position
     uint32_t cluster = file->start_cluster;
     uint32_t cluster_offset = file->position / bytes_per_cluster;
@@ -1656,6 +2542,7 @@ fat32_error_t fat32_write(fat32_file_t *file, const void *buffer, size_t size, s
         dir_entry->file_size = file->file_size;
 
         RETURN_ON_ERROR(write_sector(file->dir_entry_sector, sector_buffer));
+        path_cache_invalidate(); // Cached sizes are now stale
     }
 
     return FAT32_OK;
@@ -2120,28 +3007,43 @@ const char *fat32_error_string(fat32_error_t error)
         return "Invalid FAT size";
     case FAT32_ERROR_INVALID_RESERVED_SECTORS:
         return "Invalid reserved sectors";
+    case FAT32_ERROR_BUSY:
+        return "Another asynchronous read is in progress";
     default:
         return "Unknown error";
     }
 }
 
-// Timer callback to check SD card presence and unmount if removed
+#ifndef FAT32_HOST
+// Timer callback to check SD card presence
 static bool on_sd_card_detect(repeating_timer_t *rt)
 {
-    // All we need to do is check if the SD card is not present and
-    // if we have a mounted FAT32 file system, we will unmount it.
+    // This runs in interrupt context, so it only notes that the card went away.
+    // Unmounting clears the sector and path caches and the async read slot, which the
+    // main thread may be using mid-read; fat32_check_card() does that from the main loop
+    // (and fat32_is_ready() on the next file system call).
     //
     // This will cover the case if the SD card is changed as we mount
     // the file system when it is needed.
 
-    if (!sd_card_present() && fat32_is_mounted())
+    if (!device_present() && fat32_mounted)
     {
-        fat32_unmount();                    // Unmount if card is not present
-        mount_status = FAT32_ERROR_NO_CARD; // Update status
+        card_removed = true;
     }
 
     return true;
 }
+#endif
+
+void fat32_set_blockdev(const blockdev_t *device)
+{
+    if (blockdev)
+    {
+        device_async_wait(); // Nothing may land in async_buffer after the switch
+    }
+    fat32_unmount();
+    blockdev = device;
+}
 
 void fat32_init(void)
 {
@@ -2150,14 +3052,22 @@ void fat32_init(void)
         return; // Already initialized
     }
 
+#ifndef FAT32_HOST
     // Initialize the SD card
     sd_init();
+    if (!blockdev)
+    {
+        blockdev = blockdev_sd();
+    }
+#endif
 
     // Initialize the file system state
     fat32_unmount(); // Ensure we start unmounted
 
+#ifndef FAT32_HOST
     // Check if a SD card is present
     add_repeating_timer_ms(500, on_sd_card_detect, NULL, &sd_card_detect_timer);
+#endif
 
     fat32_initialised = true;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "blockdev.h"
+
 // FAT32 constants
 #define FAT32_SECTOR_SIZE (SD_BLOCK_SIZE) // Standard sector size
 #define FAT32_MAX_FILENAME_LEN (255)
@@ -25,6 +27,28 @@
 #define FAT32_DIR_ENTRY_END_MARKER (0x00) // End of directory entry marker
 #define FAT32_DIR_LFN_PART_SIZE (13)      // Size of each LFN part in bytes
 
+// Sector cache (fully associative, LRU, write-through). Set to 0 to disable.
+#ifndef FAT32_CACHE_SECTORS
+#define FAT32_CACHE_SECTORS (8)
+#endif
+
+// Path lookup cache for fat32_open (direct-mapped on a hash of the normalized path).
+// Set to 0 to disable. Paths longer than FAT32_PATH_CACHE_MAX_LEN are not cached.
+#ifndef FAT32_PATH_CACHE_ENTRIES
+#define FAT32_PATH_CACHE_ENTRIES (8)
+#endif
+#define FAT32_PATH_CACHE_MAX_LEN (63)
+
+// Largest asynchronous read in sectors (bounce buffer size)
+#ifndef FAT32_ASYNC_MAX_SECTORS
+#define FAT32_ASYNC_MAX_SECTORS (2)
+#endif
+
+// Extents shared by all files opened with fat32_open_pinned(). A contiguous file needs one.
+#ifndef FAT32_EXTENT_POOL
+#define FAT32_EXTENT_POOL (32)
+#endif
+
 // Error codes
 typedef enum
 {
@@ -49,6 +73,7 @@ typedef enum
     FAT32_ERROR_INVALID_CLUSTER_SIZE,
     FAT32_ERROR_INVALID_FATS,
     FAT32_ERROR_INVALID_RESERVED_SECTORS,
+    FAT32_ERROR_BUSY,
 } fat32_error_t;
 
 // File handle structure
@@ -63,8 +88,34 @@ typedef struct
     uint32_t position;
     uint32_t dir_entry_sector; // Sector containing the directory entry
     uint32_t dir_entry_offset; // Byte offset within the sector
+    uint32_t contiguous_clusters;  // Clusters known to run contiguously from start_cluster (0 = unknown)
+    uint32_t hint_cluster_index;   // Chain index of hint_cluster
+    uint32_t hint_cluster;         // Last cluster resolved past the contiguous run (0 = none)
+    uint16_t extent_first;         // First extent pool slot of a pinned file
+    uint16_t extent_count;         // Extents mapping the whole chain (0 = not pinned)
+    uint32_t mount_generation;     // Mount the handle was opened on; stale after a remount
 } fat32_file_t;
 
+// Run of clusters that lie back to back on disk
+typedef struct
+{
+    uint32_t start_cluster;
+    uint32_t length; // Clusters in the run (0 = free pool slot)
+} fat32_extent_t;
+
+// Cache and I/O counters, cumulative until fat32_reset_cache_stats()
+typedef struct
+{
+    uint32_t hits;           // read_sector calls served from the cache
+    uint32_t misses;         // read_sector calls that went to the card
+    uint32_t path_hits;      // fat32_open calls resolved from the path cache
+    uint32_t path_misses;    // fat32_open calls that scanned directories
+    uint32_t blocks_read;    // Blocks requested from the block device (sync and async)
+    uint32_t blocks_written; // Blocks written to the block device
+    uint32_t fat_reads;      // FAT entries looked up while following cluster chains
+    uint32_t bytes_read;     // File bytes returned to callers
+} fat32_cache_stats_t;
+
 // Directory entry structure
 typedef struct
 {
@@ -170,18 +221,39 @@ bool fat32_is_ready(void);
 fat32_error_t fat32_mount(void);
 void fat32_unmount(void);
 bool fat32_is_mounted(void);
+// Unmount if the card is out, or the card-detect timer saw it removed since the last check.
+// Main thread only; fat32_is_ready() (and so every file call) runs it first.
+void fat32_check_card(void);
 fat32_error_t fat32_get_status(void);
 fat32_error_t fat32_get_free_space(uint64_t *free_space);
 fat32_error_t fat32_get_total_space(uint64_t *total_space);
 fat32_error_t fat32_get_volume_name(char *name, size_t name_len);
 uint32_t fat32_get_cluster_size(void);
+void fat32_get_cache_stats(fat32_cache_stats_t *stats);
+void fat32_reset_cache_stats(void);
 
 // File operations
 fat32_error_t fat32_open(fat32_file_t *file, const char *path);
+// Open and map the whole cluster chain into the extent pool, so later seeks and reads
+// never walk the FAT. If the pool cannot hold the map the file still opens, unpinned.
+// The extents are released by fat32_close(), or by the first fat32_write().
+fat32_error_t fat32_open_pinned(fat32_file_t *file, const char *path);
+bool fat32_is_pinned(const fat32_file_t *file);
 fat32_error_t fat32_create(fat32_file_t *file, const char *path);
 fat32_error_t fat32_close(fat32_file_t *file);
+// Reads and writes on a handle opened before the card was removed fail with
+// FAT32_ERROR_NO_CARD, even once a card is mounted again; they never remount by themselves.
+// fat32_reopen() takes such a handle back, position kept, once the card is in again and the
+// file's directory entry is unchanged (FAT32_ERROR_FILE_NOT_FOUND otherwise). It mounts the
+// card if needed, so it blocks; a current handle returns FAT32_OK at once.
+fat32_error_t fat32_reopen(fat32_file_t *file);
 fat32_error_t fat32_read(fat32_file_t *file, void *buffer, size_t size, size_t *bytes_read);
 fat32_error_t fat32_write(fat32_file_t *file, const void *buffer, size_t size, size_t *bytes_written);
+// Asynchronous read: one may be in flight at a time. Reads stop at the end of the current
+// cluster or after FAT32_ASYNC_MAX_SECTORS sectors, so bytes_read can be short. Cached data
+// completes immediately (*done set); otherwise call fat32_read_async_poll() until *done.
+fat32_error_t fat32_read_async(fat32_file_t *file, void *buffer, size_t size, bool *done, size_t *bytes_read);
+fat32_error_t fat32_read_async_poll(fat32_file_t *file, bool *done, size_t *bytes_read);
 fat32_error_t fat32_seek(fat32_file_t *file, uint32_t position);
 uint32_t fat32_tell(fat32_file_t *file);
 uint32_t fat32_size(fat32_file_t *file);
@@ -200,3 +272,6 @@ fat32_error_t fat32_dir_create(fat32_file_t *dir, const char *path);
 const char *fat32_error_string(fat32_error_t error);
 
 void fat32_init(void);
+// Select the storage under the file system (unmounts first). Defaults to blockdev_sd();
+// host builds (FAT32_HOST) must set a device before mounting.
+void fat32_set_blockdev(const blockdev_t *device);
@@ -16,14 +16,45 @@
 
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
+#include "hardware/dma.h"
 
 #include "sdcard.h"
+#include "blockdev.h"
+
+#define SD_ASYNC_TOKEN_POLL_BYTES (16)    // Bytes polled for a data token per sd_async_poll()
+#define SD_ASYNC_TOKEN_TIMEOUT (100000)   // Same budget as the blocking token wait
 
 // Global state
 static bool sd_initialised = false;
 static bool is_sdhc = false;                                                      // Set this in sd_card_init()
 static uint8_t dummy_bytes[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}; // Dummy bytes for SPI read/write
 
+// Asynchronous read state
+typedef enum
+{
+    SD_ASYNC_IDLE = 0,
+    SD_ASYNC_WAIT_TOKEN, // Polling for the data start token
+    SD_ASYNC_DATA,       // DMA is moving a block
+} sd_async_state_t;
+
+static struct
+{
+    sd_async_state_t state;
+    uint8_t *buffer;      // Destination of the current block
+    uint32_t blocks_left; // Including the current block
+    uint32_t token_polls;
+    bool multi;           // CMD18 transfer that needs a CMD12
+    sd_async_callback_t callback;
+    void *context;
+} sd_async;
+
+static sd_stats_t sd_stats;
+static uint64_t sd_cs_since = 0; // time_us_64() at the last CS assert, 0 while deselected
+
+static int sd_dma_tx = -1;
+static int sd_dma_rx = -1;
+static const uint8_t sd_dma_fill = 0xFF; // Clocked out while DMA reads a block
+
 //
 // Low-level SD card SPI functions
 //
@@ -31,12 +62,21 @@ static void sd_spi_write_buf(const uint8_t *src, size_t len);
 
 static inline void sd_cs_select(void)
 {
+    if (sd_cs_since == 0)
+    {
+        sd_cs_since = time_us_64();
+    }
     gpio_put(SD_CS, 0);
     sd_spi_write_buf(dummy_bytes, 8); // Send dummy bytes to ensure CS is low for at least 8 clock cycles
 }
 
 static inline void sd_cs_deselect(void)
 {
+    if (sd_cs_since != 0)
+    {
+        sd_stats.cs_time_us += time_us_64() - sd_cs_since;
+        sd_cs_since = 0;
+    }
     gpio_put(SD_CS, 1);
     sd_spi_write_buf(dummy_bytes, 8); // Send dummy bytes to ensure CS is high for at least 8 clock cycles
 }
@@ -102,6 +142,7 @@ static uint8_t sd_send_command(uint8_t cmd, uint32_t arg)
     packet[5] = crc;
 
     // Send command
+    sd_stats.commands++;
     sd_cs_select();
     sd_spi_write_buf(packet, 6);
 
@@ -117,6 +158,42 @@ static uint8_t sd_send_command(uint8_t cmd, uint32_t arg)
     return response;
 }
 
+static bool sd_wait_data_token(void)
+{
+    uint8_t response;
+    uint32_t timeout = 100000;
+    do
+    {
+        response = sd_spi_write_read(0xFF);
+        timeout--;
+    } while (response != SD_DATA_START_BLOCK && timeout > 0);
+
+    return response == SD_DATA_START_BLOCK;
+}
+
+static uint8_t sd_stop_transmission(void)
+{
+    // CMD12 is sent while the card is still streaming, so CS stays asserted
+    uint8_t packet[6] = {0x40 | SD_CMD12, 0, 0, 0, 0, 0xFF};
+    sd_stats.commands++;
+    sd_spi_write_buf(packet, 6);
+
+    // The byte following CMD12 is a stuff byte and must be discarded
+    sd_spi_write_read(0xFF);
+
+    uint8_t response;
+    uint8_t retry = 0;
+    do
+    {
+        response = sd_spi_write_read(0xFF);
+        retry++;
+    } while ((response & 0x80) && (retry < 64));
+
+    // The card may signal busy (MISO low) after STOP_TRANSMISSION
+    sd_wait_ready();
+    return response;
+}
+
 //
 // Card detection and initialisation
 //
@@ -137,6 +214,8 @@ bool sd_is_sdhc(void)
 
 sd_error_t sd_read_block(uint32_t block, uint8_t *buffer)
 {
+    sd_async_wait();
+
     int32_t addr = is_sdhc ? block : block * SD_BLOCK_SIZE;
     uint8_t response = sd_send_command(SD_CMD17, addr);
     if (response != 0)
@@ -146,14 +225,7 @@ sd_error_t sd_read_block(uint32_t block, uint8_t *buffer)
     }
 
     // Wait for data token
-    uint32_t timeout = 100000;
-    do
-    {
-        response = sd_spi_write_read(0xFF);
-        timeout--;
-    } while (response != SD_DATA_START_BLOCK && timeout > 0);
-
-    if (timeout == 0)
+    if (!sd_wait_data_token())
     {
         sd_cs_deselect();
         return SD_ERROR_READ_FAILED;
@@ -172,6 +244,8 @@ sd_error_t sd_read_block(uint32_t block, uint8_t *buffer)
 
 sd_error_t sd_write_block(uint32_t block, const uint8_t *buffer)
 {
+    sd_async_wait();
+
     uint32_t addr = is_sdhc ? block : block * SD_BLOCK_SIZE;
     uint8_t response = sd_send_command(SD_CMD24, addr);
     if (response != 0)
@@ -209,15 +283,49 @@ sd_error_t sd_write_block(uint32_t block, const uint8_t *buffer)
 
 sd_error_t sd_read_blocks(uint32_t start_block, uint32_t num_blocks, uint8_t *buffer)
 {
+    if (num_blocks == 0)
+    {
+        return SD_OK;
+    }
+    if (num_blocks == 1)
+    {
+        return sd_read_block(start_block, buffer);
+    }
+
+    sd_async_wait();
+
+    // READ_MULTIPLE_BLOCK: one command, then a token + 512 bytes + CRC per block until CMD12
+    uint32_t addr = is_sdhc ? start_block : start_block * SD_BLOCK_SIZE;
+    uint8_t response = sd_send_command(SD_CMD18, addr);
+    if (response != 0)
+    {
+        sd_cs_deselect();
+        return SD_ERROR_READ_FAILED;
+    }
+
+    sd_error_t result = SD_OK;
     for (uint32_t i = 0; i < num_blocks; i++)
     {
-        sd_error_t result = sd_read_block(start_block + i, buffer + (i * SD_BLOCK_SIZE));
-        if (result != SD_OK)
+        if (!sd_wait_data_token())
         {
-            return result;
+            result = SD_ERROR_READ_FAILED;
+            break;
         }
+
+        sd_spi_read_buf(buffer + (i * SD_BLOCK_SIZE), SD_BLOCK_SIZE);
+
+        // Read CRC (ignore it)
+        sd_spi_write_read(0xFF);
+        sd_spi_write_read(0xFF);
     }
-    return SD_OK;
+
+    if (sd_stop_transmission() != 0)
+    {
+        result = SD_ERROR_READ_FAILED;
+    }
+
+    sd_cs_deselect();
+    return result;
 }
 
 sd_error_t sd_write_blocks(uint32_t start_block, uint32_t num_blocks, const uint8_t *buffer)
@@ -233,10 +341,162 @@ sd_error_t sd_write_blocks(uint32_t start_block, uint32_t num_blocks, const uint
     return SD_OK;
 }
 
+//
+// Asynchronous (DMA) block reads
+//
+
+static void sd_dma_start_block(uint8_t *dst)
+{
+    if (sd_dma_tx < 0)
+    {
+        sd_dma_tx = dma_claim_unused_channel(true);
+        sd_dma_rx = dma_claim_unused_channel(true);
+    }
+
+    // TX clocks 0xFF from a fixed byte, RX drains the data register into the buffer
+    dma_channel_config tx = dma_channel_get_default_config(sd_dma_tx);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_8);
+    channel_config_set_read_increment(&tx, false);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, spi_get_dreq(SD_SPI, true));
+    dma_channel_configure(sd_dma_tx, &tx, &spi_get_hw(SD_SPI)->dr, &sd_dma_fill, SD_BLOCK_SIZE, false);
+
+    dma_channel_config rx = dma_channel_get_default_config(sd_dma_rx);
+    channel_config_set_transfer_data_size(&rx, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx, false);
+    channel_config_set_write_increment(&rx, true);
+    channel_config_set_dreq(&rx, spi_get_dreq(SD_SPI, false));
+    dma_channel_configure(sd_dma_rx, &rx, dst, &spi_get_hw(SD_SPI)->dr, SD_BLOCK_SIZE, false);
+
+    // Start both together so the RX FIFO cannot overflow
+    dma_start_channel_mask((1u << sd_dma_tx) | (1u << sd_dma_rx));
+}
+
+static void sd_async_complete(sd_error_t result)
+{
+    if (sd_async.multi && sd_stop_transmission() != 0 && result == SD_OK)
+    {
+        result = SD_ERROR_READ_FAILED;
+    }
+    sd_cs_deselect();
+
+    // Go idle before the callback so it may start the next transfer
+    sd_async.state = SD_ASYNC_IDLE;
+    if (sd_async.callback)
+    {
+        sd_async.callback(result, sd_async.context);
+    }
+}
+
+sd_error_t sd_read_blocks_async(uint32_t start_block, uint32_t num_blocks, uint8_t *buffer,
+                                sd_async_callback_t callback, void *context)
+{
+    if (num_blocks == 0 || !buffer)
+    {
+        return SD_ERROR_READ_FAILED;
+    }
+
+    sd_async_wait(); // One transfer at a time
+
+    bool multi = num_blocks > 1;
+    uint32_t addr = is_sdhc ? start_block : start_block * SD_BLOCK_SIZE;
+    uint8_t response = sd_send_command(multi ? SD_CMD18 : SD_CMD17, addr);
+    if (response != 0)
+    {
+        sd_cs_deselect();
+        return SD_ERROR_READ_FAILED;
+    }
+
+    // CS stays asserted until the transfer completes
+    sd_async.state = SD_ASYNC_WAIT_TOKEN;
+    sd_async.buffer = buffer;
+    sd_async.blocks_left = num_blocks;
+    sd_async.token_polls = 0;
+    sd_async.multi = multi;
+    sd_async.callback = callback;
+    sd_async.context = context;
+    return SD_OK;
+}
+
+bool sd_async_poll(void)
+{
+    switch (sd_async.state)
+    {
+    case SD_ASYNC_WAIT_TOKEN:
+        // Poll a few bytes per call rather than spinning on the card's access time
+        for (int i = 0; i < SD_ASYNC_TOKEN_POLL_BYTES; i++)
+        {
+            uint8_t response = sd_spi_write_read(0xFF);
+            if (response == SD_DATA_START_BLOCK)
+            {
+                sd_dma_start_block(sd_async.buffer);
+                sd_async.state = SD_ASYNC_DATA;
+                return true;
+            }
+            if (++sd_async.token_polls >= SD_ASYNC_TOKEN_TIMEOUT)
+            {
+                sd_async_complete(SD_ERROR_READ_FAILED);
+                return sd_async.state != SD_ASYNC_IDLE;
+            }
+        }
+        return true;
+
+    case SD_ASYNC_DATA:
+        if (dma_channel_is_busy(sd_dma_rx))
+        {
+            return true;
+        }
+
+        // Read CRC (ignore it)
+        sd_spi_write_read(0xFF);
+        sd_spi_write_read(0xFF);
+
+        sd_async.buffer += SD_BLOCK_SIZE;
+        if (--sd_async.blocks_left == 0)
+        {
+            sd_async_complete(SD_OK);
+            return sd_async.state != SD_ASYNC_IDLE;
+        }
+        sd_async.token_polls = 0;
+        sd_async.state = SD_ASYNC_WAIT_TOKEN;
+        return true;
+
+    case SD_ASYNC_IDLE:
+    default:
+        return false;
+    }
+}
+
+bool sd_async_busy(void)
+{
+    return sd_async.state != SD_ASYNC_IDLE;
+}
+
+void sd_async_wait(void)
+{
+    while (sd_async_poll())
+    {
+        tight_loop_contents();
+    }
+}
+
 //
 // Utility functions
 //
 
+void sd_get_stats(sd_stats_t *stats)
+{
+    if (stats)
+    {
+        *stats = sd_stats;
+    }
+}
+
+void sd_reset_stats(void)
+{
+    memset(&sd_stats, 0, sizeof(sd_stats));
+}
+
 const char *sd_error_string(sd_error_t error)
 {
     switch (error)
@@ -262,6 +522,8 @@ const char *sd_error_string(sd_error_t error)
 
 sd_error_t sd_card_init(void)
 {
+    sd_async_wait();
+
     // Start with lower SPI speed for initialization (400kHz)
     spi_init(SD_SPI, SD_INIT_BAUDRATE);
 
@@ -403,3 +665,66 @@ void sd_init(void)
 
     sd_initialised = true;
 }
+
+//
+// Block device backend for the FAT32 driver
+//
+
+static bool sd_bd_present(void *context)
+{
+    (void)context;
+    return sd_card_present();
+}
+
+static sd_error_t sd_bd_init(void *context)
+{
+    (void)context;
+    return sd_card_init();
+}
+
+static sd_error_t sd_bd_read_blocks(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer)
+{
+    (void)context;
+    return sd_read_blocks(start_block, num_blocks, buffer);
+}
+
+static sd_error_t sd_bd_write_blocks(void *context, uint32_t start_block, uint32_t num_blocks, const uint8_t *buffer)
+{
+    (void)context;
+    return sd_write_blocks(start_block, num_blocks, buffer);
+}
+
+static sd_error_t sd_bd_read_blocks_async(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer,
+                                          sd_async_callback_t callback, void *callback_context)
+{
+    (void)context;
+    return sd_read_blocks_async(start_block, num_blocks, buffer, callback, callback_context);
+}
+
+static bool sd_bd_async_poll(void *context)
+{
+    (void)context;
+    return sd_async_poll();
+}
+
+static void sd_bd_async_wait(void *context)
+{
+    (void)context;
+    sd_async_wait();
+}
+
+static const blockdev_t sd_blockdev = {
+    .context = NULL,
+    .present = sd_bd_present,
+    .init = sd_bd_init,
+    .read_blocks = sd_bd_read_blocks,
+    .write_blocks = sd_bd_write_blocks,
+    .read_blocks_async = sd_bd_read_blocks_async,
+    .async_poll = sd_bd_async_poll,
+    .async_wait = sd_bd_async_wait,
+};
+
+const blockdev_t *blockdev_sd(void)
+{
+    return &sd_blockdev;
+}
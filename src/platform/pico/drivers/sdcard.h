@@ -75,5 +75,26 @@ sd_error_t sd_write_block(uint32_t block, const uint8_t *buffer);
 sd_error_t sd_read_blocks(uint32_t start_block, uint32_t num_blocks, uint8_t *buffer);
 sd_error_t sd_write_blocks(uint32_t start_block, uint32_t num_blocks, const uint8_t *buffer);
 
+// Asynchronous (DMA) block reads. One transfer may be in flight at a time and the
+// blocking functions above finish it first. sd_async_poll() advances the transfer and
+// runs the completion callback; it returns true while the transfer is still in flight.
+typedef void (*sd_async_callback_t)(sd_error_t result, void *context);
+
+sd_error_t sd_read_blocks_async(uint32_t start_block, uint32_t num_blocks, uint8_t *buffer,
+                                sd_async_callback_t callback, void *context);
+bool sd_async_poll(void);
+bool sd_async_busy(void);
+void sd_async_wait(void);
+
+// Bus counters, cumulative until sd_reset_stats()
+typedef struct
+{
+    uint32_t commands;   // Commands sent to the card
+    uint64_t cs_time_us; // Time with chip select asserted (commands, data and busy waits)
+} sd_stats_t;
+
+void sd_get_stats(sd_stats_t *stats);
+void sd_reset_stats(void);
+
 // Utility functions
 const char *sd_error_string(sd_error_t error);
@@ -12,13 +12,18 @@ struct Line2D {
 
 class DrawList {
 public:
-    void clear() { lines.clear(); }
+    void clear() { lines.clear(); hidden = 0; }
     void addLine(int16_t x0,int16_t y0,int16_t x1,int16_t y1,uint16_t c) {
         lines.push_back(Line2D{x0,y0,x1,y1,c});
     }
+    // Lines the renderer chose not to draw (hidden-edge mode), for stats only.
+    void addHidden(int n) { hidden += n; }
+    int hiddenCount() const { return hidden; }
+
     const std::vector<Line2D>& get() const { return lines; }
 private:
     std::vector<Line2D> lines;
+    int hidden = 0;
 };
 
 } // namespace gv
\ No newline at end of file
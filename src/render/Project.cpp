@@ -47,6 +47,14 @@ static inline Vec3fx sub3(const Vec3fx& a, const Vec3fx& b) {
     return Vec3fx{ a.x - b.x, a.y - b.y, a.z - b.z };
 }
 
+static inline Vec3fx add3(const Vec3fx& a, const Vec3fx& b) {
+    return Vec3fx{ a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+static inline Vec3fx scale3(const Vec3fx& a, fx s) {
+    return Vec3fx{ a.x * s, a.y * s, a.z * s };
+}
+
 static inline Vec3fx normalize3(const Vec3fx& v) {
     int64_t x = v.x.raw(), y = v.y.raw(), z = v.z.raw();
     uint64_t xx = (uint64_t)(iabs64(x)) * (uint64_t)(iabs64(x));
@@ -75,6 +83,54 @@ void buildCameraBasis(Camera& cam) {
     cam.up2   = cross3(cam.right, cam.fwd);
 }
 
+void buildFrustum(const Camera& cam, Frustum& f) {
+    // sx = cx + focal*x/z stays in [0, 2cx] while cx*z +- focal*x >= 0; dividing by focal
+    // keeps the normals near unit length, well inside fx range. The screen is widened by a
+    // pixel per side so points that toInt() rounds onto the edge still count as inside.
+    const fx kx = (cam.cx + fx::one()) / cam.focal;
+    const fx ky = (cam.cy + fx::one()) / cam.focal;
+
+    f.n[0] = add3(scale3(cam.fwd, kx), cam.right);  // left edge
+    f.n[1] = sub3(scale3(cam.fwd, kx), cam.right);  // right edge
+    f.n[2] = sub3(scale3(cam.fwd, ky), cam.up2);    // top edge
+    f.n[3] = add3(scale3(cam.fwd, ky), cam.up2);    // bottom edge
+    f.n[4] = cam.fwd;                               // near plane
+
+    for (int i = 0; i < Frustum::kPlanes; ++i) f.d[i] = -dot3(f.n[i], cam.pos);
+    f.d[4] -= fx::fromRaw((1 << fx::SHIFT) / 8); // same near distance as projectPoint()
+}
+
+bool frustumSpanX(const Frustum& f, fx y0, fx y1, fx z0, fx z1, fx& xLo, fx& xHi) {
+    // Bounds are kept in raw Q16.16 and clamped, since a plane almost parallel to X gives a
+    // huge (or no) limit.
+    constexpr int64_t kFar = int64_t(1) << 30;
+    int64_t lo = -kFar, hi = kFar;
+
+    for (int i = 0; i < Frustum::kPlanes; ++i) {
+        const Vec3fx& n = f.n[i];
+        const fx by = (n.y * y0 > n.y * y1) ? n.y * y0 : n.y * y1;
+        const fx cz = (n.z * z0 > n.z * z1) ? n.z * z0 : n.z * z1;
+        const int64_t m = (int64_t)(f.d[i] + by + cz).raw();
+        const int64_t a = n.x.raw();
+
+        // a*x + m >= 0
+        if (a > 0) {
+            const int64_t b = (-m * (1 << fx::SHIFT)) / a - 1;
+            if (b > lo) lo = b;
+        } else if (a < 0) {
+            const int64_t b = (m * (1 << fx::SHIFT)) / -a + 1;
+            if (b < hi) hi = b;
+        } else if (m < 0) {
+            return false;
+        }
+    }
+
+    if (lo > hi) return false;
+    xLo = fx::fromRaw((int32_t)lo);
+    xHi = fx::fromRaw((int32_t)hi);
+    return true;
+}
+
 bool projectPoint(const Camera& cam, const Vec3fx& world, Vec2i& out) {
     // Transform world -> view using precomputed basis
     Vec3fx v = sub3(world, cam.pos);
@@ -93,4 +149,55 @@ bool projectPoint(const Camera& cam, const Vec3fx& world, Vec2i& out) {
     return true;
 }
 
+void projectPoints(const Camera& cam, const fx* x, const fx* y, const fx* z,
+                   Vec2i* out, uint8_t* valid, int n) {
+    // Per chunk: a branch-free depth pass the compiler can unroll (and vectorize on hosts),
+    // then x/y and the divide only for points in front of the near plane.
+    constexpr int kChunk = 32;
+    int32_t vz[kChunk];
+
+    // Camera terms live in locals: stores to valid[] (uint8_t) may alias anything, and
+    // would otherwise force every field to be reloaded per point.
+    const int32_t px = cam.pos.x.raw(), py = cam.pos.y.raw(), pz = cam.pos.z.raw();
+    const int64_t rx = cam.right.x.raw(), ry = cam.right.y.raw(), rz = cam.right.z.raw();
+    const int64_t ux = cam.up2.x.raw(),   uy = cam.up2.y.raw(),   uz = cam.up2.z.raw();
+    const int64_t wx = cam.fwd.x.raw(),   wy = cam.fwd.y.raw(),   wz = cam.fwd.z.raw();
+    const fx focal = cam.focal, cx = cam.cx, cy = cam.cy;
+
+    for (int base = 0; base < n; base += kChunk) {
+        const int m = (n - base < kChunk) ? (n - base) : kChunk;
+        const fx* xs = x + base;
+        const fx* ys = y + base;
+        const fx* zs = z + base;
+
+        for (int i = 0; i < m; ++i) {
+            const int64_t dx = xs[i].raw() - px;
+            const int64_t dy = ys[i].raw() - py;
+            const int64_t dz = zs[i].raw() - pz;
+            vz[i] = (int32_t)((dx * wx + dy * wy + dz * wz) >> fx::SHIFT);
+        }
+
+        for (int i = 0; i < m; ++i) {
+            if (vz[i] <= (1 << fx::SHIFT) / 8) {
+                valid[base + i] = 0;
+                continue;
+            }
+
+            const int64_t dx = xs[i].raw() - px;
+            const int64_t dy = ys[i].raw() - py;
+            const int64_t dz = zs[i].raw() - pz;
+            const fx vx = fx::fromRaw((int32_t)((dx * rx + dy * ry + dz * rz) >> fx::SHIFT));
+            const fx vy = fx::fromRaw((int32_t)((dx * ux + dy * uy + dz * uz) >> fx::SHIFT));
+
+            const fx invz = focal / fx::fromRaw(vz[i]);
+            const fx sx = cx + vx * invz;
+            const fx sy = cy - vy * invz;
+
+            out[base + i].x = (int16_t)sx.toInt();
+            out[base + i].y = (int16_t)sy.toInt();
+            valid[base + i] = 1;
+        }
+    }
+}
+
 } // namespace gv
\ No newline at end of file
@@ -22,6 +22,29 @@ struct Camera {
 
 void buildCameraBasis(Camera& cam);
 
+// World-space planes bounding what the camera sees: the four screen edges (the screen is
+// 2*cx by 2*cy) and the near plane. A point p is inside when dot(n[i], p) + d[i] >= 0 for all i.
+struct Frustum {
+    static constexpr int kPlanes = 5;
+    Vec3fx n[kPlanes];
+    fx d[kPlanes];
+};
+
+// Needs the basis from buildCameraBasis().
+void buildFrustum(const Camera& cam, Frustum& f);
+
+// World X span [xLo, xHi] where the frustum may reach the slab y in [y0, y1], z in [z0, z1].
+// Each plane is tested against the slab's best corner on its own, so the span can be wider
+// than the exact one but never misses anything visible. Returns false when nothing is.
+bool frustumSpanX(const Frustum& f, fx y0, fx y1, fx z0, fx z1, fx& xLo, fx& xHi);
+
 bool projectPoint(const Camera& cam, const Vec3fx& world, Vec2i& out);
 
+// Batched projectPoint() over structure-of-arrays input: valid[i] is 1 where out[i] was
+// written, 0 where point i is behind the near plane. Results match projectPoint() exactly
+// for coordinates within fx range: the offset from the camera is taken in 64 bits here, where
+// projectPoint() wraps in fx.
+void projectPoints(const Camera& cam, const fx* x, const fx* y, const fx* z,
+                   Vec2i* out, uint8_t* valid, int n);
+
 } // namespace gv
\ No newline at end of file
@@ -3,12 +3,36 @@
 #include "game/Game.hpp"
 #include "game/Playfield.hpp"
 #include "game/LevelMath.hpp"
+#include "ShapeTables.hpp"
+#include <bit>
 
 namespace gv {
 
+static inline bool same3(const Vec3fx& a, const Vec3fx& b) {
+    return a.x.raw() == b.x.raw() && a.y.raw() == b.y.raw() && a.z.raw() == b.z.raw();
+}
+
 void Renderer::setCamera(const Camera& c) {
+    // The basis depends only on the look vector and up. The follow camera moves pos and
+    // target together, which leaves target - pos bit-identical, so a pure translation
+    // keeps the cached basis instead of paying for two normalize3() calls.
+    const Vec3fx look{ c.target.x - c.pos.x, c.target.y - c.pos.y, c.target.z - c.pos.z };
+    const bool reorient = !basisValid_ || !same3(look, basisLook_) || !same3(c.up, cam.up);
+
+    const Vec3fx right = cam.right, up2 = cam.up2, fwd = cam.fwd;
     cam = c;
-    buildCameraBasis(cam);
+
+    if (reorient) {
+        buildCameraBasis(cam);
+        basisLook_  = look;
+        basisValid_ = true;
+    } else {
+        cam.right = right;
+        cam.up2   = up2;
+        cam.fwd   = fwd;
+    }
+
+    buildFrustum(cam, frustum_);
 }
 
 static inline fx fi(int v) { return fx::fromInt(v); }
@@ -17,10 +41,64 @@ static inline Vec3fx add3(const Vec3fx& a, const Vec3fx& b) {
     return Vec3fx{ a.x + b.x, a.y + b.y, a.z + b.z };
 }
 
-static inline void line3(const Vec3fx& A, const Vec3fx& B, uint16_t color, const Camera& cam, DrawList& dl) {
-    Vec2i a, b;
-    if (projectPoint(cam, A, a) && projectPoint(cam, B, b))
-        dl.addLine(a.x, a.y, b.x, b.y, color);
+static inline void emitEdges(const Vec2i* p, const uint8_t* ok, const uint8_t* edges, int n,
+                             uint16_t color, DrawList& dl) {
+    for (int i = 0; i < n; i += 2) {
+        const int a = edges[i], b = edges[i + 1];
+        if (ok[a] && ok[b]) dl.addLine(p[a].x, p[a].y, p[b].x, p[b].y, color);
+    }
+}
+
+// Hidden-edge mode: faces kept for a mesh whose vertex i projected to p[base + i]. A face is
+// kept when it faces the camera (clockwise on screen, as y points down) and no solid
+// neighbour covers it; a face with a vertex behind the camera is kept to be safe.
+// A mesh without faces keeps all of its edges.
+static inline uint8_t keptFaces(const ShapeMesh& m, const Vec2i* p, const uint8_t* ok, int base,
+                                uint8_t coveredSides) {
+    if (m.faceCount == 0) return 0xFF;
+
+    uint8_t keep = 0;
+    for (int f = 0; f < m.faceCount; ++f) {
+        if (m.faceSide[f] & coveredSides) continue;
+
+        const int a = base + m.faces[f][0], b = base + m.faces[f][1], c = base + m.faces[f][2];
+        const bool front = !(ok[a] && ok[b] && ok[c]) ||
+            int64_t(p[b].x - p[a].x) * (p[c].y - p[a].y) - int64_t(p[b].y - p[a].y) * (p[c].x - p[a].x) < 0;
+        if (front) keep |= uint8_t(1u << f);
+    }
+    return keep;
+}
+
+// Emits the mesh edges that border a kept face; every edge when keep is 0xFF.
+static inline void emitMesh(const ShapeMesh& m, const Vec2i* p, const uint8_t* ok, int base,
+                            uint8_t keep, uint16_t color, DrawList& dl) {
+    int hidden = 0;
+    for (int e = 0; e < m.indexCount / 2; ++e) {
+        const int a = base + m.indices[2 * e], b = base + m.indices[2 * e + 1];
+        if (!(ok[a] && ok[b])) continue;
+        if (keep == 0xFF || (m.edgeFaces[e] & keep)) dl.addLine(p[a].x, p[a].y, p[b].x, p[b].y, color);
+        else ++hidden;
+    }
+    dl.addHidden(hidden);
+}
+
+// Indexed wireframe: project the vertex set in one batch, then emit edges by index. Shared
+// corners cost one projection instead of one per edge end; an edge is dropped when either
+// end is behind the camera.
+template <int NV, int NI>
+static inline void meshWire(const Vec3fx (&verts)[NV], const uint8_t (&edges)[NI],
+                            uint16_t color, const Camera& cam, DrawList& dl) {
+    fx x[NV], y[NV], z[NV];
+    for (int i = 0; i < NV; ++i) {
+        x[i] = verts[i].x;
+        y[i] = verts[i].y;
+        z[i] = verts[i].z;
+    }
+
+    Vec2i p[NV];
+    uint8_t ok[NV];
+    projectPoints(cam, x, y, z, p, ok, NV);
+    emitEdges(p, ok, edges, NI, color, dl);
 }
 
 static inline int iabs(int v) { return v < 0 ? -v : v; }
@@ -29,11 +107,10 @@ void Renderer::trailPushLevelPoint(fx levelX, fx y, fx z) const {
     // A large jump usually indicates a reset/spawn; clearing avoids a long diagonal streak.
     if (trailCount_ > 0) {
         const int lastIdx = (trailHead_ - 1 + kTrailMax) % kTrailMax;
-        const TrailPt last = trail_[lastIdx];
 
         // Compare in screen space (cheap) to detect teleports/resets.
         Vec2i a{}, b{};
-        Vec3fx wa{ last.levelX - levelX + fx::fromInt(kShipFixedX), last.y, last.z };
+        Vec3fx wa{ trailX_[lastIdx] - levelX + fx::fromInt(kShipFixedX), trailY_[lastIdx], trailZ_[lastIdx] };
         Vec3fx wb{ fx::fromInt(kShipFixedX), y, z };
 
         if (projectPoint(cam, wa, a) && projectPoint(cam, wb, b)) {
@@ -46,7 +123,9 @@ void Renderer::trailPushLevelPoint(fx levelX, fx y, fx z) const {
         }
     }
 
-    trail_[trailHead_] = TrailPt{ levelX, y, z };
+    trailX_[trailHead_] = levelX;
+    trailY_[trailHead_] = y;
+    trailZ_[trailHead_] = z;
     trailHead_ = (trailHead_ + 1) % kTrailMax;
     if (trailCount_ < kTrailMax) ++trailCount_;
 }
@@ -54,29 +133,31 @@ void Renderer::trailPushLevelPoint(fx levelX, fx y, fx z) const {
 void Renderer::trailDraw(DrawList& dl, fx scrollX, uint16_t color) const {
     if (trailCount_ < 2) return;
 
-    const int start = (trailHead_ - trailCount_ + kTrailMax) % kTrailMax;
+    // Convert level-space X to render-world X for the current scroll, then project every
+    // live slot in storage order; the walk below follows ring order.
+    fx x[kTrailMax];
+    for (int i = 0; i < trailCount_; ++i)
+        x[i] = trailX_[i] - scrollX + fx::fromInt(kShipFixedX);
+
+    Vec2i p[kTrailMax];
+    uint8_t ok[kTrailMax];
+    projectPoints(cam, x, trailY_.data(), trailZ_.data(), p, ok, trailCount_);
 
-    Vec2i prev{};
+    const int start = (trailHead_ - trailCount_ + kTrailMax) % kTrailMax;
     bool havePrev = false;
 
     for (int i = 0; i < trailCount_; ++i) {
         const int idx = (start + i) % kTrailMax;
-        const TrailPt tp = trail_[idx];
-
-        // Convert level-space X to render-world X for the current scroll.
-        const fx wx = tp.levelX - scrollX + fx::fromInt(kShipFixedX);
-        Vec3fx w{ wx, tp.y, tp.z };
+        const int prev = (idx - 1 + kTrailMax) % kTrailMax;
 
-        Vec2i cur{};
-        if (!projectPoint(cam, w, cur)) {
+        if (!ok[idx]) {
             havePrev = false;
             continue;
         }
 
         if (havePrev) {
-            dl.addLine(prev.x, prev.y, cur.x, cur.y, color);
+            dl.addLine(p[prev].x, p[prev].y, p[idx].x, p[idx].y, color);
         }
-        prev = cur;
         havePrev = true;
     }
 }
@@ -126,103 +207,153 @@ void Renderer::addShip(DrawList &dl, const Vec3fx &pos, uint16_t color, fx shipY
 
     rotZ(v0); rotZ(v1); rotZ(v2);
 
-    // Extrude in Z.
-    Vec3fx a0{ v0.x, v0.y, v0.z - hz }, a1{ v1.x, v1.y, v1.z - hz }, a2{ v2.x, v2.y, v2.z - hz };
-    Vec3fx b0{ v0.x, v0.y, v0.z + hz }, b1{ v1.x, v1.y, v1.z + hz }, b2{ v2.x, v2.y, v2.z + hz };
-
-    auto add = [&](const Vec3fx& p) { return Vec3fx{ pos.x + p.x, pos.y + p.y, pos.z + p.z }; };
+    // Extrude in Z: a0..a2 at -hz, b0..b2 at +hz.
+    const Vec3fx verts[] = {
+        add3(pos, { v0.x, v0.y, v0.z - hz }), add3(pos, { v1.x, v1.y, v1.z - hz }), add3(pos, { v2.x, v2.y, v2.z - hz }),
+        add3(pos, { v0.x, v0.y, v0.z + hz }), add3(pos, { v1.x, v1.y, v1.z + hz }), add3(pos, { v2.x, v2.y, v2.z + hz })
+    };
 
     // Wireframe edges.
-    line3(add(a0), add(a1), color, cam, dl);
-    line3(add(a1), add(a2), color, cam, dl);
-    line3(add(a2), add(a0), color, cam, dl);
-
-    line3(add(b0), add(b1), color, cam, dl);
-    line3(add(b1), add(b2), color, cam, dl);
-    line3(add(b2), add(b0), color, cam, dl);
+    static constexpr uint8_t indices[] = {
+        0,1, 1,2, 2,0,
+        3,4, 4,5, 5,3,
+        0,3, 1,4, 2,5
+    };
 
-    line3(add(a0), add(b0), color, cam, dl);
-    line3(add(a1), add(b1), color, cam, dl);
-    line3(add(a2), add(b2), color, cam, dl);
+    meshWire(verts, indices, color, cam, dl);
 }
 
 void Renderer::addCube(DrawList &dl, const Vec3fx &pos, uint16_t color) const
 {
-    const Vec3fx verts[] = {
-        { fx::zero(),    fx::zero(),    fx::zero()    }, { fi(kCellSize), fx::zero(),    fx::zero()    },
-        { fi(kCellSize), fi(kCellSize), fx::zero()    }, { fx::zero(),    fi(kCellSize), fx::zero()    },
-        { fx::zero(),    fx::zero(),    fi(kCellSize) }, { fi(kCellSize), fx::zero(),    fi(kCellSize) },
-        { fi(kCellSize), fi(kCellSize), fi(kCellSize) }, { fx::zero(),    fi(kCellSize), fi(kCellSize) }
-    };
-
-    const int indices[] = {
-        0,1, 1,2, 2,3, 3,0,
-        4,5, 5,6, 6,7, 7,4,
-        0,4, 1,5, 2,6, 3,7
-    };
-
-    for (size_t i = 0; i < sizeof(indices)/sizeof(indices[0]); i += 2) {
-        Vec3fx vA = add3(pos, verts[indices[i]]);
-        Vec3fx vB = add3(pos, verts[indices[i+1]]);
-        line3(vA, vB, color, cam, dl);
-    }
+    addBox(dl, pos, 1, 1, color);
 }
 
-void Renderer::addSquarePyramid(DrawList& dl, const Vec3fx& pos, uint16_t color,
-                                ModId mod, fx apexScale, const Vec3fx& origin) const
+void Renderer::addBox(DrawList& dl, const Vec3fx& pos, int cols, int rows, uint16_t color,
+                      uint8_t coveredSides) const
 {
-    const Vec3fx verts[] = {
-        { fi(kCellSize/2), apexScale*fi(kCellSize), fi(kCellSize/2) }, // apex
-        { fx::zero(),      fx::zero(),              fi(kCellSize)   }, // base corner 0
-        { fi(kCellSize),   fx::zero(),              fi(kCellSize)   }, // base corner 1
-        { fi(kCellSize),   fx::zero(),              fx::zero()      }, // base corner 2
-        { fx::zero(),      fx::zero(),              fx::zero()      }  // base corner 3
-    };
+    const fx w = fi(cols * kCellSize);
+    const fx h = fi(rows * kCellSize);
+    const fx d = fi(kCellSize);
+
+    // Same corner order as kBoxMesh, stretched to cols x rows.
+    fx x[8], y[8], z[8];
+    for (int i = 0; i < 8; ++i) {
+        const ShapeVert& v = kBoxMesh.verts[i];
+        x[i] = pos.x + (v.x ? w : fx::zero());
+        y[i] = pos.y + (v.y ? h : fx::zero());
+        z[i] = pos.z + (v.z ? d : fx::zero());
+    }
 
-    const int indices[] = {
-        0,1, 0,2, 0,3, 0,4, // sides
-        1,2, 2,3, 3,4, 4,1  // base
-    };
+    Vec2i p[8];
+    uint8_t ok[8];
+    projectPoints(cam, x, y, z, p, ok, 8);
 
-    for (size_t i = 0; i < sizeof(indices)/sizeof(indices[0]); i += 2) {
-        Vec3fx vA = add3(pos, verts[indices[i]]);
-        Vec3fx vB = add3(pos, verts[indices[i+1]]);
+    const uint8_t keep = hiddenEdges_ ? keptFaces(kBoxMesh, p, ok, 0, coveredSides) : 0xFF;
+    emitMesh(kBoxMesh, p, ok, 0, keep, color, dl);
 
-        applyMod3(mod, origin, vA);
-        applyMod3(mod, origin, vB);
+    if (!kSquareGridTicks) return;
 
-        line3(vA, vB, color, cam, dl);
+    // Cell boundaries inside a merged box: a short tick in from each edge of the near face.
+    const fx t = fi(kCellSize / 4);
+    auto tick = [&](fx x0, fx y0, fx x1, fx y1) {
+        Vec2i a, b;
+        if (projectPoint(cam, add3(pos, { x0, y0, d }), a) && projectPoint(cam, add3(pos, { x1, y1, d }), b))
+            dl.addLine(a.x, a.y, b.x, b.y, color);
+    };
+    for (int i = 1; i < cols; ++i) {
+        const fx x = fi(i * kCellSize);
+        tick(x, fx::zero(), x, t);
+        tick(x, h, x, h - t);
+    }
+    for (int i = 1; i < rows; ++i) {
+        const fx y = fi(i * kCellSize);
+        tick(fx::zero(), y, t, y);
+        tick(w, y, w - t, y);
     }
 }
 
-void Renderer::addRightTriPrism(DrawList& dl, const Vec3fx& pos, uint16_t color,
-                                ModId mod, const Vec3fx& origin) const
+void Renderer::addSquareRuns(DrawList& dl, uint16_t* squares, int count, int col0, fx scrollX,
+                             uint16_t color, const uint16_t* solid) const
 {
-    // Right triangle prism with right angle at bottom-right.
-    const Vec3fx verts[] = {
-        { fi(kCellSize), fi(kCellSize), fx::zero()    }, // front-right-top
-        { fi(kCellSize), fx::zero(),    fx::zero()    }, // front-right-bottom
-        { fx::zero(),    fx::zero(),    fx::zero()    }, // front-left-bottom
-        { fi(kCellSize), fi(kCellSize), fi(kCellSize) }, // back-right-top
-        { fi(kCellSize), fx::zero(),    fi(kCellSize) }, // back-right-bottom
-        { fx::zero(),    fx::zero(),    fi(kCellSize) }  // back-left-bottom
-    };
+    for (int i = 0; i < count; ++i) {
+        while (squares[i]) {
+            const int row = std::countr_zero(squares[i]);
+            const int rows = std::countr_one(uint16_t(squares[i] >> row));
+            const uint16_t run = uint16_t(((1u << rows) - 1) << row);
+
+            int cols = 1;
+            while (i + cols < count && (squares[i + cols] & run) == run) ++cols;
+            for (int k = 0; k < cols; ++k) squares[i + k] &= uint16_t(~run);
+
+            // A side is covered when Squares fill the whole neighbouring strip.
+            uint8_t covered = 0;
+            if (solid) {
+                const uint16_t above = uint16_t(1u << row) >> 1;     // 0 on row 0
+                const uint16_t below = uint16_t(1u << (row + rows)); // past the last row is never solid
+                uint16_t all = 0xFFFF;
+                for (int k = 0; k < cols; ++k) all &= solid[i + k];
+                if ((solid[i - 1] & run) == run)    covered |= kSideNegX;
+                if ((solid[i + cols] & run) == run) covered |= kSidePosX;
+                if (above && (all & above))         covered |= kSidePosY;
+                if (all & below)                    covered |= kSideNegY;
+            }
 
-    const int indices[] = {
-        0,1, 1,2, 2,0, // front face
-        3,4, 4,5, 5,3, // back face
-        0,3, 1,4, 2,5  // connecting edges
-    };
+            // Row numbers grow downward, so the box's low corner sits on its last row.
+            const Vec3fx pos{ worldXForColumn(col0 + i, scrollX), worldYForRow(row + rows - 1), fx::zero() };
+            addBox(dl, pos, cols, rows, color, covered);
+        }
+    }
+}
 
-    for (size_t i = 0; i < sizeof(indices)/sizeof(indices[0]); i += 2) {
-        Vec3fx vA = add3(pos, verts[indices[i]]);
-        Vec3fx vB = add3(pos, verts[indices[i+1]]);
+void Renderer::addShape(const Vec3fx& pos, const ShapeMesh& mesh, uint8_t coveredSides) const
+{
+    CellBatch& b = cells_;
+    const int base = b.vertCount;
+
+    for (int i = 0; i < mesh.vertCount; ++i) {
+        const ShapeVert& v = mesh.verts[i];
+        b.x[base + i] = pos.x + fi(v.x);
+        b.y[base + i] = pos.y + fi(v.y);
+        b.z[base + i] = pos.z + fi(v.z);
+    }
 
-        applyMod3(mod, origin, vA);
-        applyMod3(mod, origin, vB);
+    b.cells[b.cellCount++] = CellBatch::Cell{ &mesh, uint8_t(base), coveredSides };
+    b.vertCount += mesh.vertCount;
+}
+
+void Renderer::flushShapes(DrawList& dl, uint16_t color) const
+{
+    CellBatch& b = cells_;
+    if (b.vertCount == 0) return;
 
-        line3(vA, vB, color, cam, dl);
+    Vec2i p[CellBatch::kMaxVerts];
+    uint8_t ok[CellBatch::kMaxVerts];
+    projectPoints(cam, b.x, b.y, b.z, p, ok, b.vertCount);
+
+    for (int i = 0; i < b.cellCount; ++i) {
+        const CellBatch::Cell& c = b.cells[i];
+        const uint8_t keep = hiddenEdges_ ? keptFaces(*c.mesh, p, ok, c.base, c.coveredSides) : 0xFF;
+        emitMesh(*c.mesh, p, ok, c.base, keep, color, dl);
     }
+
+    b.vertCount = 0;
+    b.cellCount = 0;
+}
+
+// Column c spans world X [worldXForColumn(c), + kCellSize]. These turn a frustum span into
+// the columns that touch it, rounding outward.
+static inline int floorDiv(int64_t a, int64_t b) { return int(a >= 0 ? a / b : -((-a + b - 1) / b)); }
+
+static inline int firstColumnEndingAfter(fx x, fx scrollX) {
+    // Smallest c with c*cell - scrollX + shipX + cell >= x.
+    const int64_t a = int64_t(x.raw()) + scrollX.raw() - fi(kShipFixedX + kCellSize).raw();
+    return -floorDiv(-a, fi(kCellSize).raw());
+}
+
+static inline int lastColumnStartingBefore(fx x, fx scrollX) {
+    // Largest c with c*cell - scrollX + shipX <= x.
+    const int64_t a = int64_t(x.raw()) + scrollX.raw() - fi(kShipFixedX).raw();
+    return floorDiv(a, fi(kCellSize).raw());
 }
 
 static inline void rectWireXZ(
@@ -230,15 +361,13 @@ static inline void rectWireXZ(
     fx x0, fx x1, fx y, fx z0, fx z1,
     uint16_t color)
 {
-    Vec3fx p00{ x0, y, z0 };
-    Vec3fx p10{ x1, y, z0 };
-    Vec3fx p11{ x1, y, z1 };
-    Vec3fx p01{ x0, y, z1 };
-
-    line3(p00, p10, color, cam, dl);
-    line3(p10, p11, color, cam, dl);
-    line3(p11, p01, color, cam, dl);
-    line3(p01, p00, color, cam, dl);
+    const Vec3fx verts[] = {
+        { x0, y, z0 }, { x1, y, z0 }, { x1, y, z1 }, { x0, y, z1 }
+    };
+
+    static constexpr uint8_t indices[] = { 0,1, 1,2, 2,3, 3,0 };
+
+    meshWire(verts, indices, color, cam, dl);
 }
 
 void Renderer::buildScene(DrawList& dl, const Game& game, fx scrollX) const
@@ -256,75 +385,126 @@ void Renderer::buildScene(DrawList& dl, const Game& game, fx scrollX) const
     int scrollCol = scrollX.toInt() / kCellSize;
     if (scrollCol < 0) scrollCol = 0;
 
+    // Streamed window: the only columns the cache can hold.
     int col0 = scrollCol - kColsPadLeft;
     if (col0 < 0) col0 = 0;
 
     int col1 = col0 + kColsVisible;
     if (col1 > levelW) col1 = levelW;
 
+    // ---- Frustum culling: columns [rowCol0[r], rowCol1[r]) may show part of row r ----
+    int rowCol0[kLevelHeight], rowCol1[kLevelHeight];
+    int drawCol0 = col1, drawCol1 = col0;
+
+    for (int r = 0; r < kLevelHeight; ++r) {
+        const fx y0 = worldYForRow(r);
+        int c0 = col1, c1 = col0;
+        fx xLo, xHi;
+        if (!culling_) {
+            c0 = col0;
+            c1 = col1;
+        } else if (frustumSpanX(frustum_, y0, y0 + fi(kCellSize), fx::zero(), fi(kCellSize), xLo, xHi)) {
+            c0 = firstColumnEndingAfter(xLo, scrollX);
+            c1 = lastColumnStartingBefore(xHi, scrollX) + 1;
+            if (c0 < col0) c0 = col0;
+            if (c1 > col1) c1 = col1;
+        }
+        rowCol0[r] = c0;
+        rowCol1[r] = c1;
+        if (c0 < c1) {
+            if (c0 < drawCol0) drawCol0 = c0;
+            if (c1 > drawCol1) drawCol1 = c1;
+        }
+    }
+    if (drawCol0 > drawCol1) drawCol0 = drawCol1 = col0;
+
     // ---- Bounds planes (top/bottom of playfield) ----
     const fx z0 = fx::zero();
     const fx z1 = fi(kCellSize);
     const fx yTop = playCenterY() + playHalfH();
     const fx yBot = playCenterY() - playHalfH();
 
-    const fx xLeft  = fx::fromInt(col0 * kCellSize) - scrollX + fx::fromInt(kShipFixedX) - fi(kCellSize * 2);
-    const fx xRight = fx::fromInt(col1 * kCellSize) - scrollX + fx::fromInt(kShipFixedX) + fi(kCellSize * 2);
+    const fx xLeft  = fx::fromInt(drawCol0 * kCellSize) - scrollX + fx::fromInt(kShipFixedX) - fi(kCellSize * 2);
+    const fx xRight = fx::fromInt(drawCol1 * kCellSize) - scrollX + fx::fromInt(kShipFixedX) + fi(kCellSize * 2);
 
     rectWireXZ(dl, cam, xLeft, xRight, yTop, z0, z1, kWire);
     rectWireXZ(dl, cam, xLeft, xRight, yBot, z0, z1, kWire);
 
-    // ---- Stream + render level ----
-    Column56 col{};
-    for (int cx = col0; cx < col1; ++cx) {
-        if (!game.readLevelColumn((uint16_t)cx, col))
-            continue;
-
-        fx worldX = worldXForColumn(cx, scrollX);
-
-        for (int row = 0; row < kLevelHeight; ++row) {
-            ShapeId sid = col.shape(row);
-            if (sid == ShapeId::Empty) continue;
-
-            ModId mid = col.mod(row);
-
-            fx worldY = worldYForRow(row);
-            fx cz = fx::zero();
-
-            // Modifier origin uses per-cell center.
-            fx ox = worldX + fi(kCellSize/2);
-            fx oy = worldY + fi(kCellSize/2);
-
-            switch (sid) {
-                case ShapeId::Square:
-                    addCube(dl, {worldX, worldY, cz}, kGreen);
-                    break;
+    // ---- Render level from the streamed column window ----
+    // Squares are collected here and merged into boxes below.
+    uint16_t squares[kColsVisible] = {};
+
+    // Hidden-edge mode: every Square of the drawn columns and one either side, visible or not,
+    // so faces pressed against one can be dropped. solid[i] is column drawCol0 + i.
+    uint16_t solidBuf[kColsVisible + 2] = {};
+    uint16_t* const solid = solidBuf + 1;
+    if (hiddenEdges_) {
+        for (int cx = drawCol0 - 1; cx <= drawCol1; ++cx) {
+            const ColumnCells* col = (cx >= 0 && cx < levelW) ? game.cachedColumn((uint16_t)cx) : nullptr;
+            if (!col) continue;
+            for (uint16_t rows = col->occupied; rows; rows &= uint16_t(rows - 1)) {
+                const int row = std::countr_zero(rows);
+                if (col->shape[row] == ShapeId::Square) solid[cx - drawCol0] |= uint16_t(1u << row);
+            }
+        }
+    }
+    auto coveredSides = [&](int cx, int row) -> uint8_t {
+        if (!hiddenEdges_) return 0;
+        const int i = cx - drawCol0;
+        const uint16_t bit = uint16_t(1u << row);
+        uint8_t covered = 0;
+        if (solid[i - 1] & bit)               covered |= kSideNegX;
+        if (solid[i + 1] & bit)               covered |= kSidePosX;
+        if (solid[i] & (bit >> 1))            covered |= kSidePosY; // row 0 is the top
+        if (solid[i] & uint16_t(bit << 1))    covered |= kSideNegY;
+        return covered;
+    };
 
-                case ShapeId::RightTri:
-                    addRightTriPrism(dl, {worldX, worldY, cz}, kGreen, mid, {ox, oy, cz});
-                    break;
+    for (int cx = drawCol0; cx < drawCol1; ++cx) {
+        const ColumnCells* col = game.cachedColumn((uint16_t)cx);
+        if (!col)
+            continue;
 
-                case ShapeId::HalfSpike:
-                    addSquarePyramid(dl, {worldX, worldY, cz}, kGreen, mid, fx::half(), {ox, oy, cz});
-                    break;
+        uint16_t visible = 0;
+        for (int r = 0; r < kLevelHeight; ++r)
+            if (cx >= rowCol0[r] && cx < rowCol1[r]) visible |= uint16_t(1u << r);
 
-                case ShapeId::FullSpike:
-                    addSquarePyramid(dl, {worldX, worldY, cz}, kGreen, mid, fx::one(), {ox, oy, cz});
-                    break;
+        fx worldX = worldXForColumn(cx, scrollX);
 
-                default:
-                    break;
+        for (uint16_t rows = col->occupied & visible; rows; rows &= uint16_t(rows - 1)) {
+            const int row = std::countr_zero(rows);
+            ShapeId sid = col->shape[row];
+            ModId mid = col->mod[row];
+
+            const fx worldY = worldYForRow(row);
+
+            if (sid == ShapeId::Square) {
+                if (mergeSquares_) {
+                    squares[cx - drawCol0] |= uint16_t(1u << row);
+                } else {
+                    flushShapes(dl, kGreen); // keep cells in row order
+                    addBox(dl, {worldX, worldY, fx::zero()}, 1, 1, kGreen, coveredSides(cx, row));
+                }
+                continue;
             }
+
+            // Modifiers are baked into the table; unknown shapes have an empty mesh.
+            addShape({worldX, worldY, fx::zero()}, shapeMesh(sid, mid), coveredSides(cx, row));
         }
+
+        flushShapes(dl, kGreen);
     }
 
+    if (mergeSquares_)
+        addSquareRuns(dl, squares, drawCol1 - drawCol0, drawCol0, scrollX, kGreen, hiddenEdges_ ? solid : nullptr);
+
     // ---- Portal marker cubes ----
     {
         const LevelHeaderV1& h = game.levelHeader();
         const int portalCol = portal_abs_x(h);
         const int py = (int)h.portalY;
 
-        if (portalCol >= col0 && portalCol < col1) {
+        if (portalCol >= drawCol0 && portalCol < drawCol1) {
             const fx px = worldXForColumn(portalCol, scrollX);
             const fx cz = fx::zero();
 
@@ -4,6 +4,7 @@
 #include "DrawList.hpp"
 #include "Project.hpp"
 #include "game/Level.hpp"
+#include "ShapeTables.hpp"
 
 namespace gv {
 
@@ -16,32 +17,84 @@ public:
 
     void buildScene(DrawList& dl, const Game& game, fx scrollX) const;
 
+    // Hidden-edge mode: draw only edges of faces turned toward the camera, and drop faces
+    // pressed against a neighbouring Square. Lines left out are counted in DrawList::hiddenCount().
+    void setHiddenEdges(bool on) { hiddenEdges_ = on; }
+    bool hiddenEdges() const { return hiddenEdges_; }
+
+    // Square cells merged into boxes per visible window (kMergeSquares), or one cube each.
+    void setMergeSquares(bool on) { mergeSquares_ = on; }
+    bool mergeSquares() const { return mergeSquares_; }
+
+    // Frustum culling of columns and rows. Off, the whole streamed window is drawn: what the
+    // culled scene must match wherever it reaches the screen.
+    void setCulling(bool on) { culling_ = on; }
+    bool culling() const { return culling_; }
+
 private:
     Camera cam{};
+    Frustum frustum_{};
 
-    // --- Ship trail (level-space ring buffer) ---
-    struct TrailPt {
-        fx levelX;  // level-space X (advances with scroll)
-        fx y;       // world Y
-        fx z;       // world Z
-    };
+    // Orientation the basis in cam was built for; see setCamera().
+    Vec3fx basisLook_{};
+    bool basisValid_ = false;
+
+    bool hiddenEdges_ = kHiddenEdges;
+    bool mergeSquares_ = kMergeSquares;
+    bool culling_ = true;
 
+    // --- Ship trail (level-space ring buffer, one array per axis for projectPoints) ---
+    // Slots [0, trailCount_) are always the live ones: the ring only wraps once it is full.
     static constexpr int kTrailMax = 48;
-    mutable std::array<TrailPt, kTrailMax> trail_{};
+    mutable std::array<fx, kTrailMax> trailX_{}; // level-space X (advances with scroll)
+    mutable std::array<fx, kTrailMax> trailY_{}; // world Y
+    mutable std::array<fx, kTrailMax> trailZ_{}; // world Z
     mutable int trailCount_ = 0;
     mutable int trailHead_  = 0;
 
+    // --- Shaped cells of one column, projected as one batch ---
+    // Kept here rather than on the stack: a full column is about 1 KB.
+    struct CellBatch {
+        static constexpr int kMaxVerts = kLevelHeight * kShapeMaxVerts;
+
+        struct Cell {
+            const ShapeMesh* mesh;
+            uint8_t base;         // first vertex in x/y/z
+            uint8_t coveredSides; // CellSide bits with a solid neighbour
+        };
+
+        fx x[kMaxVerts], y[kMaxVerts], z[kMaxVerts];
+        Cell cells[kLevelHeight];
+        int vertCount = 0;
+        int cellCount = 0;
+    };
+    static_assert(CellBatch::kMaxVerts <= 256, "CellBatch::Cell::base is uint8_t");
+
+    mutable CellBatch cells_{};
+
 private:
     // --- Shape constructors ---
     void addShip(DrawList& dl, const Vec3fx& pos, uint16_t color, fx shipY, fx shipVy) const;
 
     void addCube(DrawList& dl, const Vec3fx& pos, uint16_t color) const;
 
-    void addSquarePyramid(DrawList& dl, const Vec3fx& pos, uint16_t color,
-                          ModId mod, fx apexScale, const Vec3fx& origin) const;
+    // Axis-aligned box of cols x rows cells; pos is its low corner, like addCube().
+    // coveredSides only matters in hidden-edge mode.
+    void addBox(DrawList& dl, const Vec3fx& pos, int cols, int rows, uint16_t color,
+                uint8_t coveredSides = 0) const;
+
+    // Greedy mesher for the visible window: squares[i] has a bit per Square row of column
+    // col0 + i. Each pass takes the lowest vertical run left in a column, widens it while the
+    // next columns have the same rows, and draws the result as one box.
+    // solid, if set, holds every Square of columns col0 - 1 .. col0 + count (solid[-1] is
+    // valid) and is used to cover box sides in hidden-edge mode.
+    void addSquareRuns(DrawList& dl, uint16_t* squares, int count, int col0, fx scrollX, uint16_t color,
+                       const uint16_t* solid = nullptr) const;
 
-    void addRightTriPrism(DrawList& dl, const Vec3fx& pos, uint16_t color,
-                          ModId mod, const Vec3fx& origin) const;
+    // Queue one table-driven cell (see ShapeTables.hpp); pos is the cell's low corner.
+    void addShape(const Vec3fx& pos, const ShapeMesh& mesh, uint8_t coveredSides = 0) const;
+    // Project every queued cell at once and emit their edges.
+    void flushShapes(DrawList& dl, uint16_t color) const;
 
 private:
     void trailPushLevelPoint(fx levelX, fx y, fx z) const;
@@ -0,0 +1,217 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <bit>
+#include "app/Config.hpp"
+#include "game/Level.hpp"
+#include "game/LevelMath.hpp"
+
+namespace gv {
+
+// Wireframe meshes for every (ShapeId, ModId) pair, rotated at compile time.
+// Vertices are integer offsets from the cell's low corner; modifiers rotate about the cell
+// centre exactly like applyMod3(), so drawing a cell is a table lookup plus a translate.
+// A new shape in the reserved 5..15 range only needs a kShapeDefs entry. Square is not here:
+// it ignores modifiers and is drawn by Renderer::addBox() so runs can be merged.
+
+constexpr int kShapeIdCount    = 16; // ShapeId is a 4-bit field.
+constexpr int kModIdCount      = 4;  // ModId is a 2-bit field.
+constexpr int kShapeMaxVerts   = 8;  // room for a box-like shape.
+constexpr int kShapeMaxIndices = 24; // two per edge.
+constexpr int kShapeMaxFaces   = 6;
+
+constexpr uint8_t kNoVert = 0xFF; // pads a triangle in ShapeMesh::faces
+
+// Cell sides as a bitmask: the side a face lies flat on, or the sides a solid neighbour covers.
+enum CellSide : uint8_t {
+    kSideNegX = 1 << 0,
+    kSidePosX = 1 << 1,
+    kSideNegY = 1 << 2,
+    kSidePosY = 1 << 3,
+};
+
+struct ShapeVert { int8_t x, y, z; };
+
+struct ShapeMesh {
+    uint8_t   vertCount  = 0;
+    uint8_t   indexCount = 0;
+    ShapeVert verts[kShapeMaxVerts]{};
+    uint8_t   indices[kShapeMaxIndices]{};
+
+    // Faces wind counter-clockwise seen from outside; only hidden-edge mode reads them.
+    uint8_t   faceCount = 0;
+    uint8_t   faces[kShapeMaxFaces][4]{};
+
+    // Derived at compile time by withAdjacency().
+    uint8_t   edgeFaces[kShapeMaxIndices / 2]{}; // faces bordering each edge, as a bitmask
+    uint8_t   faceSide[kShapeMaxFaces]{};        // CellSide a square face lies on, or 0
+};
+
+struct ShapeDef {
+    ShapeId   id;
+    ShapeMesh mesh; // unrotated (ModId::None)
+};
+
+namespace shape_detail {
+
+constexpr int8_t C = kCellSize;
+constexpr int8_t H = kCellSize / 2;
+constexpr uint8_t X = kNoVert;
+
+static_assert(kCellSize % 2 == 0, "cell centre must be a whole unit");
+static_assert(kCellSize <= 127, "vertices are stored as int8_t");
+
+inline constexpr ShapeDef kShapeDefs[] = {
+    // Right triangle prism with the right angle at bottom-right.
+    { ShapeId::RightTri, { 6, 18,
+        { {C,C,0}, {C,0,0}, {0,0,0},    // front: right-top, right-bottom, left-bottom
+          {C,C,C}, {C,0,C}, {0,0,C} },  // back
+        { 0,1, 1,2, 2,0,  3,4, 4,5, 5,3,  0,3, 1,4, 2,5 },
+        5, { {0,1,2,X}, {3,5,4,X}, {0,3,4,1}, {1,4,5,2}, {0,2,5,3} } } },
+
+    // Square pyramids: apex over the base centre, half or full cell tall.
+    { ShapeId::HalfSpike, { 5, 16,
+        { {H,H,H}, {0,0,C}, {C,0,C}, {C,0,0}, {0,0,0} },
+        { 0,1, 0,2, 0,3, 0,4,  1,2, 2,3, 3,4, 4,1 },
+        5, { {1,4,3,2}, {0,1,2,X}, {0,2,3,X}, {0,3,4,X}, {0,4,1,X} } } },
+
+    { ShapeId::FullSpike, { 5, 16,
+        { {H,C,H}, {0,0,C}, {C,0,C}, {C,0,0}, {0,0,0} },
+        { 0,1, 0,2, 0,3, 0,4,  1,2, 2,3, 3,4, 4,1 },
+        5, { {1,4,3,2}, {0,1,2,X}, {0,2,3,X}, {0,3,4,X}, {0,4,1,X} } } },
+};
+
+// Fills edgeFaces and faceSide from the vertices, edges and faces.
+constexpr ShapeMesh withAdjacency(ShapeMesh m) {
+    for (int e = 0; e < m.indexCount / 2; ++e) {
+        const uint8_t a = m.indices[2 * e], b = m.indices[2 * e + 1];
+        m.edgeFaces[e] = 0;
+        for (int f = 0; f < m.faceCount; ++f) {
+            const int n = (m.faces[f][3] == kNoVert) ? 3 : 4;
+            for (int j = 0; j < n; ++j) {
+                const uint8_t p = m.faces[f][j], q = m.faces[f][(j + 1) % n];
+                if ((p == a && q == b) || (p == b && q == a)) m.edgeFaces[e] |= uint8_t(1u << f);
+            }
+        }
+    }
+
+    // A four-cornered face flat on a cell side can be hidden by a solid neighbour there.
+    for (int f = 0; f < m.faceCount; ++f) {
+        m.faceSide[f] = 0;
+        if (m.faces[f][3] == kNoVert) continue;
+        uint8_t side = kSideNegX | kSidePosX | kSideNegY | kSidePosY;
+        for (int j = 0; j < 4; ++j) {
+            const ShapeVert& v = m.verts[m.faces[f][j]];
+            if (v.x != 0) side &= uint8_t(~kSideNegX);
+            if (v.x != C) side &= uint8_t(~kSidePosX);
+            if (v.y != 0) side &= uint8_t(~kSideNegY);
+            if (v.y != C) side &= uint8_t(~kSidePosY);
+        }
+        m.faceSide[f] = side;
+    }
+    return m;
+}
+
+constexpr ShapeMesh rotated(const ShapeMesh& base, ModId mod) {
+    ShapeMesh m = base;
+    const Vec3fx origin{ fx::fromInt(H), fx::fromInt(H), fx::zero() };
+    for (int i = 0; i < m.vertCount; ++i) {
+        Vec3fx p{ fx::fromInt(base.verts[i].x), fx::fromInt(base.verts[i].y), fx::fromInt(base.verts[i].z) };
+        applyMod3(mod, origin, p);
+        m.verts[i] = ShapeVert{ int8_t(p.x.toInt()), int8_t(p.y.toInt()), int8_t(p.z.toInt()) };
+    }
+    return withAdjacency(m);
+}
+
+constexpr auto buildShapeMeshes() {
+    std::array<std::array<ShapeMesh, kModIdCount>, kShapeIdCount> t{};
+    for (const ShapeDef& d : kShapeDefs)
+        for (int m = 0; m < kModIdCount; ++m)
+            t[size_t(d.id)][m] = rotated(d.mesh, ModId(m));
+    return t;
+}
+
+} // namespace shape_detail
+
+using shape_detail::kShapeDefs;
+
+inline constexpr auto kShapeMeshes = shape_detail::buildShapeMeshes();
+
+inline constexpr const ShapeMesh& shapeMesh(ShapeId id, ModId mod) {
+    return kShapeMeshes[size_t(id) & (kShapeIdCount - 1)][size_t(mod) & (kModIdCount - 1)];
+}
+
+// Unit cube in Renderer::addBox() vertex and edge order. addBox() stretches the vertices to
+// cols x rows cells and only takes the topology (edges, faces, sides) from here.
+inline constexpr ShapeMesh kBoxMesh = shape_detail::withAdjacency({ 8, 24,
+    { {0,0,0}, {shape_detail::C,0,0}, {shape_detail::C,shape_detail::C,0}, {0,shape_detail::C,0},
+      {0,0,shape_detail::C}, {shape_detail::C,0,shape_detail::C},
+      {shape_detail::C,shape_detail::C,shape_detail::C}, {0,shape_detail::C,shape_detail::C} },
+    { 0,1, 1,2, 2,3, 3,0,  4,5, 5,6, 6,7, 7,4,  0,4, 1,5, 2,6, 3,7 },
+    6, { {0,3,2,1}, {4,5,6,7}, {0,1,5,4}, {3,7,6,2}, {0,4,7,3}, {1,2,6,5} } });
+
+// ---- Compile-time checks against the runtime applyMod3() path ----
+namespace shape_detail {
+
+// Every table vertex, placed in a cell at (cx, cy), must equal applyMod3() on the
+// unrotated vertex around that cell's centre.
+constexpr bool matchesApplyMod3(int cx, int cy) {
+    for (const ShapeDef& d : kShapeDefs) {
+        for (int m = 0; m < kModIdCount; ++m) {
+            const ShapeMesh& t = shapeMesh(d.id, ModId(m));
+            if (t.vertCount != d.mesh.vertCount || t.indexCount != d.mesh.indexCount) return false;
+            const Vec3fx origin{ fx::fromInt(cx + H), fx::fromInt(cy + H), fx::zero() };
+            for (int i = 0; i < t.vertCount; ++i) {
+                Vec3fx p{ fx::fromInt(cx + d.mesh.verts[i].x), fx::fromInt(cy + d.mesh.verts[i].y),
+                          fx::fromInt(d.mesh.verts[i].z) };
+                applyMod3(ModId(m), origin, p);
+                if (p.x.raw() != fx::fromInt(cx + t.verts[i].x).raw() ||
+                    p.y.raw() != fx::fromInt(cy + t.verts[i].y).raw() ||
+                    p.z.raw() != fx::fromInt(t.verts[i].z).raw()) return false;
+            }
+            for (int i = 0; i < t.indexCount; ++i)
+                if (t.indices[i] >= t.vertCount) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(matchesApplyMod3(0, 0));
+static_assert(matchesApplyMod3(-40, 48));
+static_assert(matchesApplyMod3(317, -60));
+
+// Hidden-edge mode needs closed meshes (every edge borders exactly two faces) whose faces
+// wind outward: the normal from the first three corners points away from the centroid.
+constexpr bool closedMesh(const ShapeMesh& m) {
+    for (int e = 0; e < m.indexCount / 2; ++e)
+        if (std::popcount(m.edgeFaces[e]) != 2) return false;
+
+    int cx = 0, cy = 0, cz = 0;
+    for (int i = 0; i < m.vertCount; ++i) { cx += m.verts[i].x; cy += m.verts[i].y; cz += m.verts[i].z; }
+
+    for (int f = 0; f < m.faceCount; ++f) {
+        const ShapeVert& a = m.verts[m.faces[f][0]];
+        const ShapeVert& b = m.verts[m.faces[f][1]];
+        const ShapeVert& c = m.verts[m.faces[f][2]];
+        const int ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        const int vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        const int nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        // (a - centroid) . n, scaled by vertCount to stay in integers.
+        const int d = (a.x * m.vertCount - cx) * nx + (a.y * m.vertCount - cy) * ny + (a.z * m.vertCount - cz) * nz;
+        if (d <= 0) return false;
+    }
+    return true;
+}
+
+constexpr bool allClosed() {
+    for (const ShapeDef& d : kShapeDefs)
+        for (int m = 0; m < kModIdCount; ++m)
+            if (!closedMesh(shapeMesh(d.id, ModId(m)))) return false;
+    return closedMesh(kBoxMesh);
+}
+
+static_assert(allClosed());
+
+} // namespace shape_detail
+
+} // namespace gv
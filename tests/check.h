@@ -0,0 +1,46 @@
+#pragma once
+
+//
+//  Minimal checks for the host tests (C and C++)
+//
+//  A failed CHECK prints where and what, and the test carries on; CHECK_DONE()
+//  returns the exit status ctest reads.
+//
+
+#include <stdio.h>
+
+static int check_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond))                                                             \
+        {                                                                        \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            check_failures++;                                                    \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                           \
+    do                                                                           \
+    {                                                                            \
+        long long check_a_ = (long long)(a);                                     \
+        long long check_b_ = (long long)(b);                                     \
+        if (check_a_ != check_b_)                                                \
+        {                                                                        \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",    \
+                    __FILE__, __LINE__, #a, #b, check_a_, check_b_);             \
+            check_failures++;                                                    \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_DONE()                                                             \
+    do                                                                           \
+    {                                                                            \
+        if (check_failures)                                                      \
+        {                                                                        \
+            fprintf(stderr, "%d check(s) failed\n", check_failures);             \
+            return 1;                                                            \
+        }                                                                        \
+        return 0;                                                                \
+    } while (0)
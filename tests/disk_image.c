@@ -0,0 +1,166 @@
+//
+//  FAT32 over a disk image for the host tests
+//
+
+#include <stdio.h>
+
+#include "disk_image.h"
+#include "fat32.h"
+
+static FILE *image = NULL;
+static blockdev_file_t file_device;
+static blockdev_latency_t latency_device;
+static const blockdev_t *inner = NULL;
+static blockdev_t counting_device;
+
+static bool present = true;
+static disk_image_counts_t counts;
+
+static bool counting_present(void *context)
+{
+    (void)context;
+    return present && inner->present(inner->context);
+}
+
+static sd_error_t counting_init(void *context)
+{
+    (void)context;
+    return present ? inner->init(inner->context) : SD_ERROR_NO_CARD;
+}
+
+static sd_error_t counting_read_blocks(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer)
+{
+    (void)context;
+    if (!present)
+    {
+        return SD_ERROR_NO_CARD;
+    }
+    counts.transfers++;
+    counts.blocks_read += num_blocks;
+    return inner->read_blocks(inner->context, start_block, num_blocks, buffer);
+}
+
+static sd_error_t counting_write_blocks(void *context, uint32_t start_block, uint32_t num_blocks, const uint8_t *buffer)
+{
+    (void)context;
+    if (!present)
+    {
+        return SD_ERROR_NO_CARD;
+    }
+    counts.transfers++;
+    counts.blocks_written += num_blocks;
+    return inner->write_blocks(inner->context, start_block, num_blocks, buffer);
+}
+
+static sd_error_t counting_read_blocks_async(void *context, uint32_t start_block, uint32_t num_blocks, uint8_t *buffer,
+                                             sd_async_callback_t callback, void *callback_context)
+{
+    (void)context;
+    if (!present)
+    {
+        return SD_ERROR_NO_CARD;
+    }
+    counts.transfers++;
+    counts.blocks_read += num_blocks;
+    return inner->read_blocks_async(inner->context, start_block, num_blocks, buffer, callback, callback_context);
+}
+
+static bool counting_async_poll(void *context)
+{
+    (void)context;
+    return inner->async_poll(inner->context);
+}
+
+static void counting_async_wait(void *context)
+{
+    (void)context;
+    inner->async_wait(inner->context);
+}
+
+bool disk_image_open(const char *path)
+{
+    image = fopen(path, "r+b");
+    if (!image)
+    {
+        fprintf(stderr, "cannot open disk image %s\n", path);
+        return false;
+    }
+
+    inner = blockdev_latency_init(&latency_device, blockdev_file_init(&file_device, image), NULL);
+    counting_device = (blockdev_t){
+        .context = NULL,
+        .present = counting_present,
+        .init = counting_init,
+        .read_blocks = counting_read_blocks,
+        .write_blocks = counting_write_blocks,
+        .read_blocks_async = counting_read_blocks_async,
+        .async_poll = counting_async_poll,
+        .async_wait = counting_async_wait,
+    };
+    present = true;
+    disk_image_reset_counts();
+
+    fat32_set_blockdev(&counting_device);
+    fat32_init();
+    return true;
+}
+
+void disk_image_close(void)
+{
+    if (image)
+    {
+        fat32_unmount();
+        fclose(image);
+        image = NULL;
+    }
+}
+
+void disk_image_set_present(bool is_present)
+{
+    present = is_present;
+}
+
+const disk_image_counts_t *disk_image_counts(void)
+{
+    return &counts;
+}
+
+void disk_image_reset_counts(void)
+{
+    counts = (disk_image_counts_t){0};
+    blockdev_latency_reset_stats(&latency_device);
+}
+
+blockdev_latency_t *disk_image_latency(void)
+{
+    return &latency_device;
+}
+
+//
+//  sdcard.h for host builds: the card is the image
+//
+
+void sd_init(void)
+{
+}
+
+sd_error_t sd_card_init(void)
+{
+    return present ? SD_OK : SD_ERROR_NO_CARD;
+}
+
+bool sd_card_present(void)
+{
+    return present;
+}
+
+void sd_get_stats(sd_stats_t *stats)
+{
+    stats->commands = counts.transfers;
+    stats->cs_time_us = latency_device.stats.elapsed_us;
+}
+
+void sd_reset_stats(void)
+{
+    disk_image_reset_counts();
+}
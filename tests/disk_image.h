@@ -0,0 +1,44 @@
+#pragma once
+
+//
+//  FAT32 over a disk image for the host tests
+//
+//  The image file sits under the latency model (blockdev_latency) and a thin
+//  counting layer that can also pretend the card was pulled, so tests see the
+//  same driver code the game runs on the SD card. The sdcard.h calls that
+//  PicoFileSystem makes outside FAT32 (sd_card_present, sd_get_stats, ...) are
+//  answered from the same image, so it builds for the host unchanged.
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "blockdev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t transfers;   // Read and write calls that reached the image
+    uint32_t blocks_read; // Blocks read, sync and async
+    uint32_t blocks_written;
+} disk_image_counts_t;
+
+// Open the image and make it the FAT32 block device (not mounted yet)
+bool disk_image_open(const char *path);
+void disk_image_close(void);
+
+// Card detect: while absent every access fails with SD_ERROR_NO_CARD
+void disk_image_set_present(bool present);
+
+const disk_image_counts_t *disk_image_counts(void);
+void disk_image_reset_counts(void);
+
+// Simulated SD time of everything since the last reset
+blockdev_latency_t *disk_image_latency(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""Build a small FAT32 disk image holding files under /levels, for the host tests."""
+from __future__ import annotations
+
+import argparse
+import os
+import struct
+import sys
+from typing import List
+
+# -----------------------------
+# Geometry: the smallest volume that is still FAT32 (>= 65525 clusters)
+# -----------------------------
+BYTES_PER_SECTOR = 512
+RESERVED_SECTORS = 32
+NUM_FATS = 2
+CLUSTERS = 66000
+END_OF_CHAIN = 0x0FFFFFFF
+
+ATTR_DIRECTORY = 0x10
+ATTR_ARCHIVE = 0x20
+
+
+class Image:
+    def __init__(self, spc: int) -> None:
+        self.spc = spc
+        self.fat_sectors = ((CLUSTERS + 2) * 4 + BYTES_PER_SECTOR - 1) // BYTES_PER_SECTOR
+        self.total_sectors = RESERVED_SECTORS + NUM_FATS * self.fat_sectors + CLUSTERS * spc
+        self.fat = [0] * (CLUSTERS + 2)
+        self.fat[0] = 0x0FFFFFF8
+        self.fat[1] = END_OF_CHAIN
+        self.next_free = 2
+        self.data = {}  # cluster -> bytes
+
+    @property
+    def cluster_bytes(self) -> int:
+        return self.spc * BYTES_PER_SECTOR
+
+    def alloc(self, count: int, fragment: bool) -> List[int]:
+        # Fragmented files skip a free cluster after every run of two, so no run is longer than two.
+        chain = []
+        c = self.next_free
+        for i in range(count):
+            chain.append(c)
+            c += 2 if fragment and i % 2 == 1 else 1
+        self.next_free = c
+        for a, b in zip(chain, chain[1:]):
+            self.fat[a] = b
+        self.fat[chain[-1]] = END_OF_CHAIN
+        return chain
+
+    def store(self, data: bytes, fragment: bool = False) -> int:
+        count = max(1, (len(data) + self.cluster_bytes - 1) // self.cluster_bytes)
+        chain = self.alloc(count, fragment)
+        for i, c in enumerate(chain):
+            self.data[c] = data[i * self.cluster_bytes:(i + 1) * self.cluster_bytes]
+        return chain[0]
+
+    def cluster_sector(self, cluster: int) -> int:
+        return RESERVED_SECTORS + NUM_FATS * self.fat_sectors + (cluster - 2) * self.spc
+
+    def write(self, path: str, root_cluster: int) -> None:
+        boot = bytearray(BYTES_PER_SECTOR)
+        boot[0:3] = b"\xEB\x58\x90"
+        boot[3:11] = b"MSWIN4.1"
+        struct.pack_into("<HBHBHHBHHHII", boot, 11, BYTES_PER_SECTOR, self.spc, RESERVED_SECTORS, NUM_FATS,
+                         0, 0, 0xF8, 0, 63, 255, 0, self.total_sectors)
+        struct.pack_into("<IHHIHH", boot, 36, self.fat_sectors, 0, 0, root_cluster, 1, 6)
+        boot[64] = 0x80
+        boot[66] = 0x29
+        boot[71:82] = b"GV3D TESTS "
+        boot[82:90] = b"FAT32   "
+        boot[510:512] = b"\x55\xAA"
+
+        fsinfo = bytearray(BYTES_PER_SECTOR)
+        struct.pack_into("<I", fsinfo, 0, 0x41615252)
+        struct.pack_into("<III", fsinfo, 484, 0x61417272, CLUSTERS + 2 - self.next_free, self.next_free)
+        struct.pack_into("<I", fsinfo, 508, 0xAA550000)
+
+        fat = b"".join(struct.pack("<I", v) for v in self.fat)
+
+        # Only written sectors are stored; the rest of the file is a hole that reads as zeros.
+        with open(path, "wb") as f:
+            f.truncate(self.total_sectors * BYTES_PER_SECTOR)
+            f.seek(0)
+            f.write(boot)
+            f.write(fsinfo)
+            for k in range(NUM_FATS):
+                f.seek((RESERVED_SECTORS + k * self.fat_sectors) * BYTES_PER_SECTOR)
+                f.write(fat)
+            for c, chunk in self.data.items():
+                f.seek(self.cluster_sector(c) * BYTES_PER_SECTOR)
+                f.write(chunk)
+
+
+def short_name(name: str) -> bytes:
+    if name in (".", ".."):
+        return name.ljust(11).encode("ascii")
+    base, _, ext = name.upper().partition(".")
+    if not base or len(base) > 8 or len(ext) > 3:
+        raise ValueError(f"'{name}' is not an 8.3 name")
+    return (base.ljust(8) + ext.ljust(3)).encode("ascii")
+
+
+def pattern_byte(i: int) -> int:
+    # Differs between neighbouring sectors; tests/test_storage.c computes the same bytes.
+    return (i * 7 + (i >> 9)) & 0xFF
+
+
+def dir_entry(name: str, attr: int, cluster: int, size: int) -> bytes:
+    return short_name(name) + bytes([attr, 0, 0]) + struct.pack("<HHHHHHHI", 0, 0, 0, cluster >> 16, 0, 0, cluster & 0xFFFF, size)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("-o", "--output", required=True, help="image file to write")
+    ap.add_argument("--spc", type=int, default=1, help="sectors per cluster")
+    ap.add_argument("--fragment", action="append", default=[], metavar="FILE",
+                    help="allocate FILE in short runs instead of one contiguous run (repeatable)")
+    ap.add_argument("--pattern", action="append", default=[], metavar="NAME:BYTES",
+                    help="also place a generated file NAME of BYTES bytes, byte i = pattern_byte(i) (repeatable)")
+    ap.add_argument("files", nargs="*", help="files to place in /levels, in directory order")
+    args = ap.parse_args()
+
+    img = Image(args.spc)
+    root = img.alloc(1, False)[0]
+    levels = img.alloc(1, False)[0]
+
+    fragment = {os.path.basename(p).upper() for p in args.fragment}
+    entries = [dir_entry(".", ATTR_DIRECTORY, levels, 0), dir_entry("..", ATTR_DIRECTORY, 0, 0)]
+    try:
+        contents = []
+        for path in args.files:
+            with open(path, "rb") as f:
+                contents.append((os.path.basename(path), f.read()))
+        for spec in args.pattern:
+            name, _, size = spec.partition(":")
+            contents.append((name, bytes(pattern_byte(i) for i in range(int(size)))))
+
+        for name, data in contents:
+            first = img.store(data, fragment=name.upper() in fragment)
+            entries.append(dir_entry(name, ATTR_ARCHIVE, first, len(data)))
+    except (OSError, ValueError) as e:
+        print(f"mkimage: {e}", file=sys.stderr)
+        return 1
+
+    listing = b"".join(entries)
+    if len(listing) > img.cluster_bytes:
+        print("mkimage: too many files for a one-cluster directory", file=sys.stderr)
+        return 1
+    img.data[levels] = listing
+    img.data[root] = dir_entry("LEVELS", ATTR_DIRECTORY, levels, 0)
+
+    img.write(args.output, root)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""Copy a level JSON without its authored obstacles, starting on the portal row.
+
+Flying level for tests that play whole levels: a ship that holds its row reaches the
+portal. Width, header and endcap stay as in the source, so the binaries have the same
+shape and size (GVL1) as the real level.
+
+With --band only the obstacles on the portal row and the rows either side of it go;
+the rest of the level stays as authored.
+
+--repeat N lays the authored part of the level N times end to end before the endcap,
+for a level wider than the shipped ones.
+"""
+from __future__ import annotations
+
+import json
+import sys
+
+
+def main() -> int:
+    args = sys.argv[1:]
+    band = "--band" in args
+    if band:
+        args.remove("--band")
+    repeat = 1
+    if "--repeat" in args:
+        i = args.index("--repeat")
+        repeat = int(args[i + 1])
+        del args[i:i + 2]
+    if len(args) != 2 or repeat < 1:
+        print(f"usage: {sys.argv[0]} [--band] [--repeat N] <level.json> <out.json>", file=sys.stderr)
+        return 2
+
+    with open(args[0], "r", encoding="utf-8") as f:
+        obj = json.load(f)
+
+    # The editor re-appends the endcap on export; everything else in the list was authored.
+    row = obj["portal"]["y"]
+    if band:
+        obj["obstacles"] = [o for o in obj["obstacles"] if abs(o["y"] - row) > 1]
+    else:
+        obj["obstacles"] = []
+    obj["start"]["y"] = row
+
+    if repeat > 1:
+        body = obj["width"] - obj["endcap"]["width"]
+        authored = [o for o in obj["obstacles"] if o["x"] < body]
+        obj["obstacles"] = [dict(o, x=o["x"] + k * body) for k in range(repeat) for o in authored]
+        obj["width"] = body * repeat + obj["endcap"]["width"]
+        obj["portal"]["x"] = obj["width"] - 1 + obj["portal"]["dx"]
+
+    with open(args[1], "w", encoding="utf-8") as f:
+        json.dump(obj, f, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
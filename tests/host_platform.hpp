@@ -0,0 +1,65 @@
+#pragma once
+// IPlatform for host tests: PicoFileSystem on the disk image, a display that draws nothing,
+// scripted keys, and a clock made of whole frames plus the modelled card time, so an App
+// frame that waits on storage takes longer exactly as it would on the device.
+
+#include "platform/IPlatform.hpp"
+#include "platform/Keys.hpp"
+#include "platform/pico/PicoFileSystem.hpp"
+#include "disk_image.h"
+
+namespace gv::test {
+
+constexpr uint32_t kFrameUs = 28571; // ~35 FPS, the display's frame rate
+
+inline uint64_t cardUs() { return disk_image_latency()->stats.elapsed_us; }
+
+class NullDisplay final : public IDisplay {
+public:
+    int width() const override { return 320; }
+    int height() const override { return 320; }
+    void beginFrame() override {}
+    void drawLines(const DrawList&) override {}
+    void endFrame() override {}
+};
+
+// Space is the only key; the test sets it before each frame.
+class ScriptedInput final : public IInput {
+public:
+    void init() override {}
+    void update() override {
+        pressed_ = space && !was_;
+        was_ = space;
+    }
+    bool down(uint8_t key) const override { return key == KEY_SPACE && was_; }
+    bool pressed(uint8_t key) const override { return key == KEY_SPACE && pressed_; }
+
+    bool space = false;
+
+private:
+    bool was_ = false;
+    bool pressed_ = false;
+};
+
+class HostPlatform final : public IPlatform {
+public:
+    void init() override {}
+    uint32_t dtUs() override {
+        frameClock_ += kFrameUs;
+        return kFrameUs;
+    }
+    uint64_t nowUs() override { return frameClock_ + cardUs(); }
+    IDisplay& display() override { return display_; }
+    IFileSystem& fs() override { return fs_; }
+    IInput& input() override { return input_; }
+
+    ScriptedInput& keys() { return input_; }
+
+private:
+    uint64_t frameClock_ = 0;
+    NullDisplay display_;
+    ScriptedInput input_;
+    PicoFileSystem fs_;
+};
+
+} // namespace gv::test
@@ -0,0 +1,95 @@
+// Level streaming replay on the simulated SD card.
+//
+// Scrolls through each level at kScrollSpeed and issues the fetches Game::streamColumns()
+// would: visible columns that are missing, then one unit ahead per frame. The disk image sits
+// under the SPI SD latency model, so the report is modelled card time per frame.
+//
+// usage: replay_bench <disk.img> [level path ...]     (default: levels/L01.BIN levels/L02.BIN)
+
+#include <cstdio>
+#include "app/Config.hpp"
+#include "game/LevelSource.hpp"
+#include "platform/pico/PicoFileSystem.hpp"
+#include "disk_image.h"
+
+using namespace gv;
+
+namespace {
+
+constexpr uint32_t kFrameUs = 28571; // ~35 FPS, the display's frame rate
+
+uint64_t cardUs() { return disk_image_latency()->stats.elapsed_us; }
+
+bool replay(IFileSystem& fs, const char* path) {
+    const uint64_t open0 = cardUs();
+    LevelSource level;
+    if (!level.open(fs, path)) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    const uint64_t openUs = cardUs() - open0;
+
+    const int width = int(level.header().width);
+    const fx dt = fx::fromMicros(kFrameUs);
+    uint8_t buf[LevelSource::kUnitBytes];
+    Column56 cols[kColsPrefetch];
+
+    fx scroll{};
+    int streamHi = 0;
+    int frames = 0, ioFrames = 0;
+    uint64_t totalUs = 0, worstUs = 0;
+    const uint32_t blocks0 = disk_image_counts()->blocks_read;
+
+    for (int lo = 0; lo < width; ++frames) {
+        lo = scroll.toInt() / kCellSize - kColsPadLeft;
+        if (lo < 0) lo = 0;
+        const int need = (lo + kColsVisible < width) ? lo + kColsVisible : width;
+
+        const uint64_t t0 = cardUs();
+        while (streamHi < need) {
+            if (!level.readUnit(streamHi, buf, cols)) return false;
+            streamHi += level.unitCount(streamHi);
+        }
+        if (streamHi < width && streamHi + level.unitCols() <= lo + kColCacheCols) {
+            if (!level.readUnit(streamHi, buf, cols)) return false;
+            streamHi += level.unitCount(streamHi);
+        }
+        const uint64_t us = cardUs() - t0;
+
+        totalUs += us;
+        if (us > worstUs) worstUs = us;
+        if (us > 0) ++ioFrames;
+        scroll = scroll + kScrollSpeed * dt;
+    }
+
+    std::printf("%-16s %4d cols  open %6.2f ms  %5d frames (%4d with I/O)  %7.3f ms/frame  worst %6.2f ms  %5u blocks\n",
+                path, width, openUs / 1000.0, frames, ioFrames, totalUs / 1000.0 / frames, worstUs / 1000.0,
+                unsigned(disk_image_counts()->blocks_read - blocks0));
+    level.close();
+    return true;
+}
+
+} // anon
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <disk.img> [level path ...]\n", argv[0]);
+        return 2;
+    }
+
+    PicoFileSystem fs;
+    if (!fs.init()) {
+        std::fprintf(stderr, "cannot mount %s\n", argv[1]);
+        return 1;
+    }
+
+    static const char* const kDefault[] = { "levels/L01.BIN", "levels/L02.BIN" };
+    const char* const* paths = (argc > 2) ? argv + 2 : kDefault;
+    const int count = (argc > 2) ? argc - 2 : 2;
+
+    bool ok = true;
+    for (int i = 0; i < count; ++i) ok = replay(fs, paths[i]) && ok;
+
+    disk_image_close();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,384 @@
+//
+//  An SDHC card in SPI mode for the host tests, over a disk image
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hardware/dma.h"
+#include "hardware/spi.h"
+#include "pico/stdlib.h"
+
+#include "sd_card_model.h"
+#include "sdcard.h"
+
+#define OUT_QUEUE_BYTES 1024 // Holds a response plus one data block
+#define DMA_CHANNELS 12
+
+static FILE *image = NULL;
+static bool present = true;
+static bool selected = false; // CS low
+static sd_card_model_counts_t counts;
+
+// Command being clocked in, and the bytes the card sends back in order
+static uint8_t command[6];
+static int command_length = 0;
+static uint8_t out_queue[OUT_QUEUE_BYTES];
+static uint32_t out_head = 0;
+static uint32_t out_tail = 0;
+
+// CMD18 in progress: the next block is queued as soon as the previous one has gone out
+static bool streaming = false;
+static uint32_t stream_block = 0;
+
+static void send(uint8_t byte)
+{
+    out_queue[out_tail++ % OUT_QUEUE_BYTES] = byte;
+}
+
+static void send_block(uint32_t block)
+{
+    uint8_t data[SD_BLOCK_SIZE];
+    if (fseek(image, (long)block * SD_BLOCK_SIZE, SEEK_SET) != 0 ||
+        fread(data, 1, SD_BLOCK_SIZE, image) != SD_BLOCK_SIZE)
+    {
+        memset(data, 0, sizeof(data));
+    }
+    counts.blocks_read++;
+
+    send(0xFF); // Access time: a couple of idle bytes before the token
+    send(0xFF);
+    send(SD_DATA_START_BLOCK);
+    for (int i = 0; i < SD_BLOCK_SIZE; i++)
+    {
+        send(data[i]);
+    }
+    send(0x00); // CRC, not checked in SPI mode
+    send(0x00);
+}
+
+static void run_command(void)
+{
+    uint8_t index = command[0] & 0x3F;
+    uint32_t arg = ((uint32_t)command[1] << 24) | ((uint32_t)command[2] << 16) | ((uint32_t)command[3] << 8) | command[4];
+
+    if (streaming && index == SD_CMD12)
+    {
+        // Drop the rest of the block in flight. A stuff byte that is not a valid R1 follows
+        // the command, then R1, a busy byte and ready.
+        counts.cmd12++;
+        streaming = false;
+        out_head = out_tail;
+        send(0xFF);
+        send(0x3F);
+        send(0x00);
+        send(0x00);
+        send(0xFF);
+        return;
+    }
+
+    send(0xFF); // NCR: one byte before the response
+    switch (index)
+    {
+    case SD_CMD0:
+    case SD_CMD55:
+        send(SD_R1_IDLE_STATE);
+        break;
+    case SD_CMD8:
+        send(SD_R1_IDLE_STATE);
+        send(0x00);
+        send(0x00);
+        send(0x01);       // 2.7-3.6 V
+        send(arg & 0xFF); // Echoed check pattern
+        break;
+    case SD_ACMD41:
+    case SD_CMD16:
+        send(0x00);
+        break;
+    case SD_CMD58:
+        send(0x00);
+        send(0xC0); // Powered up, CCS: block addressed (SDHC)
+        send(0xFF);
+        send(0x80);
+        send(0x00);
+        break;
+    case SD_CMD17:
+        counts.cmd17++;
+        send(0x00);
+        send_block(arg);
+        break;
+    case SD_CMD18:
+        counts.cmd18++;
+        send(0x00);
+        streaming = true;
+        stream_block = arg;
+        break;
+    default:
+        send(SD_R1_ILLEGAL_COMMAND);
+        break;
+    }
+}
+
+static uint8_t transfer(uint8_t mosi)
+{
+    if (!selected || !present)
+    {
+        return 0xFF;
+    }
+    counts.spi_bytes++;
+
+    // Commands start 01xxxxxx; the host clocks 0xFF while it reads
+    if (command_length > 0 || (mosi & 0xC0) == 0x40)
+    {
+        command[command_length++] = mosi;
+        if (command_length == sizeof(command))
+        {
+            command_length = 0;
+            run_command();
+        }
+    }
+
+    // Streaming queues the next block once the host clocks for it (not while it sends CMD12)
+    if (out_head == out_tail && streaming && command_length == 0 && mosi == 0xFF)
+    {
+        send_block(stream_block++);
+    }
+    if (out_head == out_tail)
+    {
+        return 0xFF;
+    }
+    return out_queue[out_head++ % OUT_QUEUE_BYTES];
+}
+
+bool sd_card_model_open(const char *path)
+{
+    image = fopen(path, "rb");
+    present = true;
+    sd_card_model_reset_counts();
+    return image != NULL;
+}
+
+void sd_card_model_close(void)
+{
+    if (image)
+    {
+        fclose(image);
+        image = NULL;
+    }
+}
+
+void sd_card_model_set_present(bool value)
+{
+    present = value;
+    if (!present)
+    {
+        streaming = false;
+        command_length = 0;
+        out_head = out_tail;
+    }
+}
+
+const sd_card_model_counts_t *sd_card_model_counts(void)
+{
+    return &counts;
+}
+
+void sd_card_model_reset_counts(void)
+{
+    memset(&counts, 0, sizeof(counts));
+}
+
+//
+// Pico SDK: GPIO, time and timers
+//
+
+void gpio_init(uint pin) { (void)pin; }
+void gpio_set_dir(uint pin, bool out) { (void)pin; (void)out; }
+void gpio_set_function(uint pin, int fn) { (void)pin; (void)fn; }
+void gpio_pull_up(uint pin) { (void)pin; }
+
+void gpio_put(uint pin, bool value)
+{
+    if (pin != SD_CS)
+    {
+        return;
+    }
+    selected = !value;
+    if (!selected)
+    {
+        // Deselecting abandons whatever the card was sending
+        streaming = false;
+        command_length = 0;
+        out_head = out_tail;
+    }
+}
+
+bool gpio_get(uint pin)
+{
+    return pin == SD_DETECT ? !present : false; // Card detect is active low
+}
+
+// Every call moves the clock on, so the driver's timeouts run out on a silent card
+static uint64_t now_us = 0;
+
+uint64_t time_us_64(void)
+{
+    return ++now_us;
+}
+
+void busy_wait_us(uint64_t delay_us)
+{
+    now_us += delay_us;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out)
+{
+    (void)delay_ms;
+    (void)callback;
+    out->user_data = user_data;
+    return true;
+}
+
+//
+// Pico SDK: SPI
+//
+
+static spi_hw_t spi_registers;
+spi_inst_t *const spi0 = (spi_inst_t *)&spi_registers;
+
+uint spi_init(spi_inst_t *spi, uint baudrate)
+{
+    (void)spi;
+    return baudrate;
+}
+
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate)
+{
+    (void)spi;
+    return baudrate;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+    (void)spi;
+    for (size_t i = 0; i < len; i++)
+    {
+        transfer(src[i]);
+    }
+    return (int)len;
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    (void)spi;
+    for (size_t i = 0; i < len; i++)
+    {
+        dst[i] = transfer(src[i]);
+    }
+    return (int)len;
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi)
+{
+    (void)spi;
+    return &spi_registers;
+}
+
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx)
+{
+    (void)spi;
+    return is_tx ? 0 : 1;
+}
+
+//
+// Pico SDK: DMA. The receiving channel (the one that writes to memory) clocks its whole
+// transfer through the card when started, then reads busy for a few polls.
+//
+
+typedef struct
+{
+    volatile void *write_addr;
+    uint count;
+    bool write_increment;
+    int busy_polls;
+} dma_channel_t;
+
+static dma_channel_t channels[DMA_CHANNELS];
+static int next_channel = 0;
+
+int dma_claim_unused_channel(bool required)
+{
+    (void)required;
+    return next_channel < DMA_CHANNELS ? next_channel++ : -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    (void)channel;
+    dma_channel_config config = {false};
+    return config;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *config, enum dma_channel_transfer_size size)
+{
+    (void)config;
+    (void)size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *config, bool increment)
+{
+    (void)config;
+    (void)increment;
+}
+
+void channel_config_set_write_increment(dma_channel_config *config, bool increment)
+{
+    config->write_increment = increment;
+}
+
+void channel_config_set_dreq(dma_channel_config *config, uint dreq)
+{
+    (void)config;
+    (void)dreq;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    (void)read_addr;
+    (void)trigger;
+    channels[channel].write_addr = write_addr;
+    channels[channel].count = transfer_count;
+    channels[channel].write_increment = config->write_increment;
+}
+
+void dma_start_channel_mask(uint32_t mask)
+{
+    for (uint ch = 0; ch < DMA_CHANNELS; ch++)
+    {
+        if (!(mask & (1u << ch)))
+        {
+            continue;
+        }
+        channels[ch].busy_polls = 3;
+        if (channels[ch].write_increment)
+        {
+            uint8_t *dst = (uint8_t *)channels[ch].write_addr;
+            for (uint i = 0; i < channels[ch].count; i++)
+            {
+                dst[i] = transfer(0xFF);
+            }
+        }
+    }
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    if (channels[channel].busy_polls > 0)
+    {
+        channels[channel].busy_polls--;
+        return true;
+    }
+    return false;
+}
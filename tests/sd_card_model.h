@@ -0,0 +1,39 @@
+#pragma once
+
+//
+//  An SDHC card in SPI mode for the host tests, over a disk image
+//
+//  sdcard.c runs unchanged on top of it: the Pico SDK calls it makes (sdk/)
+//  land here, and the bytes it clocks through SPI and DMA drive the card's
+//  command state machine. Block n of the card is byte n * 512 of the image.
+//  Read only; writes are rejected as illegal commands.
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t cmd17;       // READ_SINGLE_BLOCK commands
+    uint32_t cmd18;       // READ_MULTIPLE_BLOCK commands
+    uint32_t cmd12;       // STOP_TRANSMISSION commands ending a CMD18 stream
+    uint32_t blocks_read; // Data blocks sent, single or streamed
+    uint64_t spi_bytes;   // Bytes clocked with CS asserted
+} sd_card_model_counts_t;
+
+bool sd_card_model_open(const char *path);
+void sd_card_model_close(void);
+
+// Card detect switch (the card starts inserted)
+void sd_card_model_set_present(bool present);
+
+const sd_card_model_counts_t *sd_card_model_counts(void);
+void sd_card_model_reset_counts(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8,
+    DMA_SIZE_16,
+    DMA_SIZE_32
+};
+
+typedef struct
+{
+    bool write_increment;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *config, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *config, bool increment);
+void channel_config_set_write_increment(dma_channel_config *config, bool increment);
+void channel_config_set_dreq(dma_channel_config *config, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_start_channel_mask(uint32_t mask);
+bool dma_channel_is_busy(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct spi_inst spi_inst_t;
+typedef struct
+{
+    volatile uint32_t dr; // The DMA channels point at it; the model never reads it
+} spi_hw_t;
+
+extern spi_inst_t *const spi0;
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len);
+spi_hw_t *spi_get_hw(spi_inst_t *spi);
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,3 @@
+#pragma once
+
+// Included by fat32.c; nothing from it is used
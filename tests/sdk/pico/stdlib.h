@@ -0,0 +1,44 @@
+#pragma once
+
+//
+//  The slice of the Pico SDK that sdcard.c and fat32.c use, for the host build
+//  against sd_card_model.c (which implements everything declared here)
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+#define GPIO_IN 0
+#define GPIO_OUT 1
+#define GPIO_FUNC_SPI 1
+
+void gpio_init(uint pin);
+void gpio_set_dir(uint pin, bool out);
+void gpio_set_function(uint pin, int fn);
+void gpio_pull_up(uint pin);
+void gpio_put(uint pin, bool value);
+bool gpio_get(uint pin);
+
+uint64_t time_us_64(void);
+void busy_wait_us(uint64_t delay_us);
+static inline void tight_loop_contents(void) {}
+
+// Never fires on the host: tests poll card detect themselves
+typedef struct repeating_timer
+{
+    void *user_data;
+} repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *timer);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+// App on the fixture image with the modelled card clock: the next level preloads during
+// the fly-out without any frame spending more than kPreloadBudgetUs on storage.
+//
+// usage: test_app <disk.img>     (the "open" levels: no obstacles, start on the portal row)
+
+#include "app/App.hpp"
+#include "app/Config.hpp"
+#include "check.h"
+#include "host_platform.hpp"
+
+using namespace gv;
+using namespace gv::test;
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+
+    static HostPlatform platform;
+    static App app;   // carries the game's column cache; too big for the stack
+    app.start(platform);
+
+    // Tapping thrust every other frame holds the ship on its row, so each level ends in
+    // the fly-out. Three levels' worth of frames covers two level switches.
+    constexpr int kFrames = 3 * 1700;
+    int ioFrames = 0, bursts = 0;
+    uint64_t worstUs = 0;
+    bool lastHadIo = false;
+
+    for (int i = 0; i < kFrames; ++i) {
+        platform.keys().space = (i & 1) == 0;
+
+        const uint64_t t0 = cardUs();
+        app.frame();
+        const uint64_t us = cardUs() - t0;
+
+        if (us > worstUs) worstUs = us;
+        if (us > kPreloadBudgetUs) std::fprintf(stderr, "frame %d: %llu us of storage\n", i, (unsigned long long)us);
+        CHECK(us <= kPreloadBudgetUs);
+
+        if (us > 0) {
+            ++ioFrames;
+            if (!lastHadIo) ++bursts;
+        }
+        lastHadIo = us > 0;
+    }
+
+    std::printf("%d frames with storage I/O in %d bursts, worst %llu us (budget %u us)\n",
+                ioFrames, bursts, (unsigned long long)worstUs, unsigned(kPreloadBudgetUs));
+
+    // Levels are resident, so the only I/O after start() is the preload of each next level.
+    CHECK(bursts >= 2);
+
+    disk_image_close();
+    CHECK_DONE();
+}
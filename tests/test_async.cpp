@@ -0,0 +1,402 @@
+// Asynchronous reads step by step. blockdev_file reports a transfer on the poll after the one
+// that started it, so each state of fat32_read_async()/FatFile::readAsync() can be looked at
+// in between: the slot taken by another file, a window refill in flight, the sector rewritten
+// or the card unmounted mid-transfer. Then Game::pumpPrefetch() on every way a read can end.
+//
+// usage: test_async <async.img>     (the wide band level L03.BIN and the generated DATA.BIN,
+//                                    which is rewritten in place and put back)
+
+#include <cstdint>
+#include <cstring>
+
+#include "app/Config.hpp"
+#include "check.h"
+#include "game/Game.hpp"
+#include "game/LevelSource.hpp"
+#include "host_platform.hpp"
+
+using namespace gv;
+using namespace gv::test;
+
+static const char* const kData = "levels/DATA.BIN";
+static const char* const kLevel = "levels/L03.BIN";
+
+static PicoFileSystem fs;
+
+// Content of the generated DATA.BIN (mkimage.py pattern_byte)
+static uint8_t patternByte(size_t i) {
+    return uint8_t(i * 7 + (i >> 9));
+}
+
+static bool matchesPattern(const uint8_t* data, size_t offset, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        if (data[i] != patternByte(offset + i)) return false;
+    }
+    return true;
+}
+
+static bool untouched(const uint8_t* data, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        if (data[i] != 0xEE) return false;
+    }
+    return true;
+}
+
+// Each test below reads its own sectors of DATA.BIN, so nothing starts out in the FAT32 cache
+// and every asynchronous read goes to the card.
+
+// While one file's transfer is in flight, another file's readAsync() finds the slot taken
+// (FAT32_ERROR_BUSY) and reads synchronously instead; the first transfer is left alone
+static void test_busy_falls_back_to_blocking() {
+    IFile* a = fs.openRead(kData);
+    IFile* b = fs.openRead(kData);
+    IFile* c = fs.openRead(kData);
+    CHECK(a && b && c);
+    if (!a || !b || !c) return;
+    c->hint(AccessPattern::ForwardWindow, 1024);
+
+    uint8_t bufA[512], bufB[512], bufC[64];
+    std::memset(bufA, 0xEE, sizeof(bufA));
+    size_t got = 0;
+    CHECK(a->seek(1024));
+    CHECK(a->readAsync(bufA, sizeof(bufA), got) == IoStatus::Pending);
+    CHECK(untouched(bufA, sizeof(bufA)));
+
+    // Unbuffered: the read goes straight to fat32_read
+    CHECK(b->seek(2048));
+    CHECK(b->readAsync(bufB, sizeof(bufB), got) == IoStatus::Done);
+    CHECK_EQ(got, sizeof(bufB));
+    CHECK(matchesPattern(bufB, 2048, sizeof(bufB)));
+    CHECK_EQ(b->tell(), 2048 + sizeof(bufB));
+
+    // Windowed: the window is filled with a blocking read and the caller gets its slice
+    CHECK(c->seek(3072 + 100));
+    CHECK(c->readAsync(bufC, sizeof(bufC), got) == IoStatus::Done);
+    CHECK_EQ(got, sizeof(bufC));
+    CHECK(matchesPattern(bufC, 3072 + 100, sizeof(bufC)));
+
+    CHECK(a->poll(got) == IoStatus::Done);
+    CHECK_EQ(got, sizeof(bufA));
+    CHECK(matchesPattern(bufA, 1024, sizeof(bufA)));
+    CHECK_EQ(a->tell(), 1024 + sizeof(bufA));
+
+    a->close();
+    b->close();
+    c->close();
+}
+
+// A window miss starts the refill and returns Pending; the file refuses other calls until
+// poll() lands the refill and copies the caller's slice into its buffer. The rest of the
+// window is then served with no transfer
+static void test_window_refill_completes_into_caller() {
+    IFile* f = fs.openRead(kData);
+    CHECK(f);
+    if (!f) return;
+    f->hint(AccessPattern::ForwardWindow, 1024);
+
+    uint8_t dst[64];
+    std::memset(dst, 0xEE, sizeof(dst));
+    size_t got = 0;
+    CHECK(f->seek(5120 + 100));
+    CHECK(f->readAsync(dst, sizeof(dst), got) == IoStatus::Pending);
+    CHECK_EQ(got, 0);
+
+    CHECK(!f->seek(0));
+    CHECK(!f->read(dst, 1, got));
+    CHECK(f->readAsync(dst, 1, got) == IoStatus::Error);
+    CHECK(untouched(dst, sizeof(dst)));
+
+    CHECK(f->poll(got) == IoStatus::Done);
+    CHECK_EQ(got, sizeof(dst));
+    CHECK(matchesPattern(dst, 5120 + 100, sizeof(dst)));
+    CHECK_EQ(f->tell(), 5120 + 100 + sizeof(dst));
+
+    disk_image_reset_counts();
+    CHECK(f->readAsync(dst, sizeof(dst), got) == IoStatus::Done);
+    CHECK_EQ(got, sizeof(dst));
+    CHECK(matchesPattern(dst, 5120 + 100 + sizeof(dst), sizeof(dst)));
+    CHECK_EQ(disk_image_counts()->transfers, 0);
+
+    f->close();
+}
+
+// A write into the sectors being transferred marks the transfer stale: its data predates the
+// write, so poll() reads the range again and the caller sees the new bytes
+static void test_write_mid_transfer_reads_again() {
+    constexpr size_t kAt = 7168;
+    constexpr size_t kPatchAt = kAt + 32;
+    IFile* f = fs.openRead(kData);
+    fat32_file_t w;
+    CHECK(f);
+    CHECK_EQ(fat32_open(&w, kData), FAT32_OK);
+    if (!f) return;
+
+    uint8_t dst[512];
+    size_t got = 0;
+    CHECK(f->seek(kAt));
+    CHECK(f->readAsync(dst, sizeof(dst), got) == IoStatus::Pending);
+
+    uint8_t patch[16];
+    std::memset(patch, 0xA5, sizeof(patch));
+    size_t put = 0;
+    CHECK_EQ(fat32_seek(&w, kPatchAt), FAT32_OK);
+    CHECK_EQ(fat32_write(&w, patch, sizeof(patch), &put), FAT32_OK);
+    CHECK_EQ(put, sizeof(patch));
+
+    CHECK(f->poll(got) == IoStatus::Done);
+    CHECK_EQ(got, sizeof(dst));
+    CHECK(std::memcmp(dst + (kPatchAt - kAt), patch, sizeof(patch)) == 0);
+    CHECK(matchesPattern(dst, kAt, kPatchAt - kAt));
+    CHECK(matchesPattern(dst + (kPatchAt - kAt) + sizeof(patch), kPatchAt + sizeof(patch),
+                         sizeof(dst) - (kPatchAt - kAt) - sizeof(patch)));
+    f->close();
+
+    // Put DATA.BIN back as generated
+    for (size_t i = 0; i < sizeof(patch); ++i) patch[i] = patternByte(kPatchAt + i);
+    CHECK_EQ(fat32_seek(&w, kPatchAt), FAT32_OK);
+    CHECK_EQ(fat32_write(&w, patch, sizeof(patch), &put), FAT32_OK);
+    fat32_close(&w);
+}
+
+// Unmounted mid-transfer (the card was pulled), the read completes Done with nothing: the
+// data is not trusted and the caller's buffer is left alone. Unbuffered and windowed
+static void test_unmount_mid_transfer_reads_nothing() {
+    const size_t at[2] = { 9216, 11264 };
+    for (int windowed = 0; windowed < 2; ++windowed) {
+        IFile* f = fs.openRead(kData);
+        CHECK(f);
+        if (!f) return;
+        if (windowed) f->hint(AccessPattern::ForwardWindow, 1024);
+
+        uint8_t dst[512];
+        std::memset(dst, 0xEE, sizeof(dst));
+        size_t got = 0;
+        CHECK(f->seek(at[windowed]));
+        CHECK(f->readAsync(dst, windowed ? 64 : sizeof(dst), got) == IoStatus::Pending);
+
+        fat32_unmount();
+        got = 1;
+        CHECK(f->poll(got) == IoStatus::Done);
+        CHECK_EQ(got, 0);
+        CHECK(untouched(dst, sizeof(dst)));
+        f->close();
+        CHECK(fs.remount());
+    }
+}
+
+// ---- Game::pumpPrefetch() ----
+
+// The level file with one asynchronous completion scripted: once `after` reads have completed,
+// the next one to end the chosen way (at once from readAsync(), or from a poll) comes back
+// as `outcome` instead. Completions can also be cut to `chunk` bytes. Everything else passes
+// through to the FatFile.
+class ScriptedFile final : public IFile {
+public:
+    enum class Outcome : uint8_t { Data, Error, Empty };
+
+    bool read(void* dst, size_t bytes, size_t& outRead) override { return inner->read(dst, bytes, outRead); }
+    bool seek(size_t absOffset) override { return inner->seek(absOffset); }
+    size_t tell() const override { return inner->tell(); }
+
+    IoStatus readAsync(void* dst, size_t bytes, size_t& outRead) override {
+        asked_ = bytes;
+        return finish(inner->readAsync(dst, (bytes < chunk) ? bytes : chunk, outRead), outRead, false);
+    }
+    IoStatus poll(size_t& outRead) override { return finish(inner->poll(outRead), outRead, true); }
+
+    void hint(AccessPattern pattern, size_t windowBytes) override { inner->hint(pattern, windowBytes); }
+    void close() override {
+        inner->close();
+        inner = nullptr;
+    }
+
+    void script(size_t chunkBytes, Outcome o, bool onPoll, int afterCompletions) {
+        chunk = chunkBytes;
+        outcome = o;
+        polled = onPoll;
+        after = afterCompletions;
+        completions = shortCompletions = 0;
+        fired = pending = false;
+    }
+
+    IFile* inner = nullptr;
+    size_t chunk = SIZE_MAX;
+    Outcome outcome = Outcome::Data;
+    bool polled = false;
+    int after = 0;
+
+    int completions = 0;
+    int shortCompletions = 0;  // completed with less than the caller asked for
+    bool fired = false;        // the scripted outcome has been returned
+    bool pending = false;      // a transfer is in flight
+
+private:
+    IoStatus finish(IoStatus st, size_t& outRead, bool fromPoll) {
+        pending = st == IoStatus::Pending;
+        if (pending) return st;
+
+        if (!fired && outcome != Outcome::Data && completions >= after && fromPoll == polled) {
+            fired = true;
+            ++completions;
+            outRead = 0;
+            return (outcome == Outcome::Error) ? IoStatus::Error : IoStatus::Done;
+        }
+        ++completions;
+        if (st == IoStatus::Done && outRead < asked_) ++shortCompletions;
+        return st;
+    }
+
+    size_t asked_ = 0;
+};
+
+class ScriptedFileSystem final : public IFileSystem {
+public:
+    bool init() override { return fs.init(); }
+    IFile* openRead(const char* path) override { return wrap(fs.openRead(path)); }
+    IFile* openPinned(const char* path) override { return wrap(fs.openPinned(path)); }
+    bool remount() override { return fs.remount(); }
+
+    ScriptedFile file;
+
+private:
+    IFile* wrap(IFile* f) {
+        if (!f) return nullptr;
+        file.inner = f;
+        return &file;
+    }
+};
+
+static ScriptedFileSystem scripted;
+static Game game; // carries the column cache; too big for the stack
+static Column56 fileCols[kMaxLevelWidth];
+static int fileWidth = 0;
+
+static bool readLevel() {
+    LevelSource src;
+    uint8_t buf[LevelSource::kUnitBytes];
+    if (!src.open(fs, kLevel)) return false;
+    fileWidth = int(src.header().width);
+    const bool ok = fileWidth <= int(sizeof(fileCols) / sizeof(fileCols[0])) &&
+                    src.readColumns(0, fileWidth, buf, fileCols);
+    src.close();
+    return ok;
+}
+
+// One game tick, tapping thrust every other frame to hold the row; returns how many visible
+// columns are missing or differ from the file
+static int tick(int i) {
+    InputState in;
+    in.thrust = (i & 1) == 0;
+    in.thrustPressed = in.thrust;
+    game.update(in, fx::fromMicros(kFrameUs));
+
+    int lo = game.scrollX().toInt() / kCellSize - kColsPadLeft;
+    if (lo < 0) lo = 0;
+    int hi = lo + kColsVisible;
+    if (hi > fileWidth) hi = fileWidth;
+
+    int bad = 0;
+    for (int c = lo; c < hi; ++c) {
+        const ColumnCells* col = game.cachedColumn((uint16_t)c);
+        if (!col) {
+            ++bad;
+            continue;
+        }
+        const ColumnCells want = ColumnCells::decode(fileCols[c]);
+        if (col->occupied != want.occupied || std::memcmp(col->shape, want.shape, sizeof(want.shape)) != 0 ||
+            std::memcmp(col->mod, want.mod, sizeof(want.mod)) != 0) {
+            ++bad;
+        }
+    }
+    return bad;
+}
+
+using Outcome = ScriptedFile::Outcome;
+
+static void loadScripted(size_t chunk, Outcome outcome, bool onPoll, int after) {
+    scripted.file.script(chunk, outcome, onPoll, after);
+    CHECK(game.loadLevel(kLevel, LevelResidency::Streamed));
+    CHECK(!game.levelResident());
+}
+
+// Reads that come back a few bytes at a time, at once or after a poll: the prefetch keeps
+// asking for the rest and the unit is stored whole
+static void test_short_completions_assemble_units() {
+    loadScripted(5, Outcome::Data, false, 0);
+    int bad = 0, i = 0;
+    for (; !game.finishedScroll() && i < 8 * fileWidth; ++i) bad += tick(i);
+    CHECK_EQ(bad, 0);
+    CHECK(!game.levelOffline());
+    CHECK(game.finishedScroll());
+    CHECK(scripted.file.shortCompletions > fileWidth / kColsPrefetch);
+    std::printf("short completions: %d frames, %d completions (%d short)\n", i,
+                scripted.file.completions, scripted.file.shortCompletions);
+    game.unloadLevel();
+}
+
+// A failed or empty completion, straight from readAsync() or from a poll, takes the level
+// offline; after reconnect() the window streams on and matches the file again
+static void test_failed_completion_goes_offline(Outcome outcome, bool onPoll) {
+    loadScripted(SIZE_MAX, outcome, onPoll, 3);
+    int i = 0;
+    for (; !game.levelOffline() && i < 8 * fileWidth; ++i) CHECK_EQ(tick(i), 0);
+    CHECK(game.levelOffline());
+    CHECK(scripted.file.fired);
+    CHECK(game.state() == RunState::Running);
+
+    CHECK(game.reconnect());
+    int bad = 0;
+    for (; !game.finishedScroll() && i < 8 * fileWidth; ++i) bad += tick(i);
+    CHECK_EQ(bad, 0);
+    CHECK(!game.levelOffline());
+    CHECK(game.finishedScroll());
+    game.unloadLevel();
+}
+
+// The card unmounted while a prefetch is in flight: FatFile completes it Done with 0 bytes,
+// which takes the level offline; after the remount and reconnect() it streams on
+static void test_unmount_mid_prefetch_goes_offline() {
+    loadScripted(SIZE_MAX, Outcome::Data, false, 0);
+    int i = 0;
+    for (; !scripted.file.pending && i < 8 * fileWidth; ++i) CHECK_EQ(tick(i), 0);
+    CHECK(scripted.file.pending);
+    CHECK(!game.levelOffline());
+
+    fat32_unmount();
+    tick(i++);
+    CHECK(game.levelOffline());
+    CHECK(!scripted.file.pending);
+
+    CHECK(fs.remount());
+    CHECK(game.reconnect());
+    int bad = 0;
+    for (; !game.finishedScroll() && i < 8 * fileWidth; ++i) bad += tick(i);
+    CHECK_EQ(bad, 0);
+    CHECK(game.finishedScroll());
+    game.unloadLevel();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <async.img>\n", argv[0]);
+        return 2;
+    }
+    CHECK(fs.init());
+
+    test_busy_falls_back_to_blocking();
+    test_window_refill_completes_into_caller();
+    test_write_mid_transfer_reads_again();
+    test_unmount_mid_transfer_reads_nothing();
+
+    CHECK(readLevel());
+    game.setFileSystem(&scripted);
+    test_short_completions_assemble_units();
+    for (bool onPoll : { false, true }) {
+        test_failed_completion_goes_offline(Outcome::Error, onPoll);
+        test_failed_completion_goes_offline(Outcome::Empty, onPoll);
+    }
+    test_unmount_mid_prefetch_goes_offline();
+
+    disk_image_close();
+    CHECK_DONE();
+}
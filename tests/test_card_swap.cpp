@@ -0,0 +1,100 @@
+// A streamed level with the card pulled and put back mid-run (the simulated card-detect
+// switch of disk_image): play keeps scrolling while offline, no frame waits on storage,
+// and after the remount the window streams on from where the scroll got to.
+//
+// usage: test_card_swap <disk.img>     (the "open" levels: no obstacles, start on the portal row)
+
+#include "app/Config.hpp"
+#include "check.h"
+#include "game/Game.hpp"
+#include "host_platform.hpp"
+
+using namespace gv;
+using namespace gv::test;
+
+static PicoFileSystem fs;
+static Game game; // carries the column cache; too big for the stack
+
+// One game tick; returns the card time it took. Tapping thrust every other frame holds the row.
+static uint64_t frame(int i) {
+    InputState in;
+    in.thrust = (i & 1) == 0;
+    in.thrustPressed = in.thrust;
+
+    const uint64_t t0 = cardUs();
+    game.update(in, fx::fromMicros(kFrameUs));
+    return cardUs() - t0;
+}
+
+static int windowLo() {
+    const int lo = game.scrollX().toInt() / kCellSize - kColsPadLeft;
+    return lo < 0 ? 0 : lo;
+}
+
+static bool visibleCached() {
+    int hi = windowLo() + kColsVisible;
+    if (hi > int(game.levelHeader().width)) hi = int(game.levelHeader().width);
+    for (int c = windowLo(); c < hi; ++c) {
+        if (!game.cachedColumn((uint16_t)c)) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+    CHECK(fs.init());
+    game.setFileSystem(&fs);
+    CHECK(game.loadLevel("levels/L01.BIN", LevelResidency::Streamed));
+    CHECK(!game.levelResident());
+
+    int i = 0;
+    for (; i < 60; ++i) CHECK(frame(i) <= kPreloadBudgetUs);
+    CHECK(game.state() == RunState::Running);
+    CHECK(visibleCached());
+
+    // Pulled: the level goes offline at the first read the read-ahead window cannot serve.
+    // Far more than the cache holds scrolls by after that, so the window runs past the
+    // columns in RAM, and the scroll never stops.
+    disk_image_set_present(false);
+    fs.checkMedia();
+    const int pulledAt = i;
+    int offlineFrames = 0;
+    bool ranPastCache = false;
+    for (; offlineFrames < 200 && i < 1200; ++i) {
+        const fx before = game.scrollX();
+        CHECK(frame(i) <= kPreloadBudgetUs);
+        CHECK(game.scrollX() > before);
+        CHECK(game.state() == RunState::Running);
+        if (game.levelOffline()) ++offlineFrames;
+        if (!visibleCached()) ranPastCache = true;
+    }
+    CHECK(game.levelOffline());
+    CHECK(ranPastCache);
+
+    // Back in: the remount and reconnect run between frames and refill the visible window.
+    const int reinsertedAt = i;
+    disk_image_set_present(true);
+    CHECK(fs.remount());
+    CHECK(game.reconnect());
+    CHECK(!game.levelOffline());
+    CHECK(visibleCached());
+
+    uint64_t worstUs = 0;
+    for (; i < 3000 && game.state() == RunState::Running; ++i) {
+        const uint64_t us = frame(i);
+        if (us > worstUs) worstUs = us;
+        CHECK(us <= kPreloadBudgetUs);
+        CHECK(visibleCached());
+    }
+    CHECK(!game.levelOffline());
+    CHECK(game.state() == RunState::FinishedFlyOut);
+
+    std::printf("card out for frames %d-%d, level done at frame %d, worst frame after %llu us\n",
+                pulledAt, reinsertedAt, i, (unsigned long long)worstUs);
+
+    disk_image_close();
+    CHECK_DONE();
+}
@@ -0,0 +1,138 @@
+// FatFile, PicoFileSystem's IFile over fat32_file_t, on the fixture image: the fixed pool of
+// handles, and what a column read costs with and without the read-ahead window.
+//
+// usage: test_fatfile <disk.img>
+
+#include <cstring>
+
+#include "check.h"
+#include "game/Level.hpp"
+#include "platform/pico/PicoFileSystem.hpp"
+#include "disk_image.h"
+
+using namespace gv;
+
+static PicoFileSystem fs;
+static const char* const kLevel = "levels/L02.BIN";
+
+// The level straight through fat32_read, for comparison
+static uint8_t expected[8192];
+static size_t expectedSize = 0;
+
+static bool readExpected() {
+    fat32_file_t f;
+    if (fat32_open(&f, kLevel) != FAT32_OK) return false;
+    const bool ok = f.file_size <= sizeof(expected) && fat32_read(&f, expected, f.file_size, &expectedSize) == FAT32_OK;
+    fat32_close(&f);
+    return ok && expectedSize > sizeof(LevelHeaderV1);
+}
+
+// Every open takes a free slot of the fixed pool (no allocation); the fifth open fails until
+// one is closed, and the closed slot is reused (user-007)
+static void test_pool_has_fixed_slots() {
+    IFile* files[PicoFileSystem::kMaxFiles];
+    for (int i = 0; i < PicoFileSystem::kMaxFiles; ++i) {
+        files[i] = fs.openRead(kLevel);
+        CHECK(files[i] != nullptr);
+        for (int j = 0; j < i; ++j) CHECK(files[i] != files[j]);
+    }
+    CHECK(fs.openRead(kLevel) == nullptr);
+
+    files[1]->close();
+    IFile* again = fs.openRead(kLevel);
+    CHECK(again == files[1]);
+    CHECK(fs.openRead(kLevel) == nullptr);
+
+    // Missing files and directories leave the slot free
+    files[2]->close();
+    CHECK(fs.openRead("levels/NOPE.BIN") == nullptr);
+    CHECK(fs.openRead("levels") == nullptr);
+    files[2] = fs.openRead(kLevel);
+    CHECK(files[2] != nullptr);
+
+    // Each handle keeps its own position
+    uint8_t a[4], b[4];
+    size_t n = 0;
+    CHECK(files[0]->seek(100) && files[3]->seek(200));
+    CHECK(files[0]->read(a, sizeof(a), n) && n == sizeof(a));
+    CHECK(files[3]->read(b, sizeof(b), n) && n == sizeof(b));
+    CHECK(std::memcmp(a, expected + 100, sizeof(a)) == 0);
+    CHECK(std::memcmp(b, expected + 200, sizeof(b)) == 0);
+    CHECK_EQ(files[0]->tell(), 104);
+    CHECK_EQ(files[3]->tell(), 204);
+
+    for (IFile* f : files) f->close();
+}
+
+struct ColumnCost {
+    int columns = 0;
+    uint32_t fat32Calls = 0; // column reads that reached fat32_read
+    uint32_t fat32Bytes = 0; // bytes fat32_read copied out
+    uint32_t blocksRead = 0;
+};
+
+// Seek + read of every column, the way LevelSource fetches them one at a time
+static ColumnCost readColumns(bool windowed) {
+    ColumnCost cost;
+    IFile* f = fs.openRead(kLevel);
+    CHECK(f != nullptr);
+    if (!f) return cost;
+    if (windowed) f->hint(AccessPattern::ForwardWindow, FatFile::kWindowBytes);
+
+    const IoStats before = fs.stats();
+    int bad = 0;
+    for (size_t off = sizeof(LevelHeaderV1); off + kColumnBytes <= expectedSize; off += kColumnBytes) {
+        uint8_t col[kColumnBytes];
+        size_t n = 0;
+        if (!f->seek(off) || !f->read(col, sizeof(col), n) || n != sizeof(col) ||
+            std::memcmp(col, expected + off, sizeof(col)) != 0) {
+            ++bad;
+        }
+        ++cost.columns;
+    }
+    const IoStats after = fs.stats();
+    f->close();
+
+    CHECK_EQ(bad, 0);
+    cost.fat32Calls = uint32_t(cost.columns) - (after.windowHits - before.windowHits);
+    cost.fat32Bytes = after.bytesRead - before.bytesRead;
+    cost.blocksRead = after.blocksRead - before.blocksRead;
+    return cost;
+}
+
+// Unbuffered, a column read is one fat32_read straight into the caller's buffer; with the
+// window, columns come from RAM and FAT32 copies each byte of the level once (user-007)
+static void test_column_read_cost() {
+    const ColumnCost direct = readColumns(false);
+    const ColumnCost windowed = readColumns(true);
+    const uint32_t payload = uint32_t(expectedSize - sizeof(LevelHeaderV1));
+    const uint32_t refills = (uint32_t(expectedSize) + FatFile::kWindowBytes - 1) / FatFile::kWindowBytes;
+
+    CHECK_EQ(direct.fat32Calls, direct.columns);
+    CHECK_EQ(direct.fat32Bytes, direct.columns * kColumnBytes);
+    CHECK(windowed.fat32Calls <= refills);
+    CHECK(windowed.fat32Bytes <= expectedSize);
+    CHECK(windowed.fat32Bytes >= payload);
+
+    std::printf("%s, %d columns: direct %.2f fat32 calls and %.1f bytes copied per column (%u blocks), "
+                "windowed %.3f calls and %.1f bytes (%u blocks)\n",
+                kLevel, direct.columns, double(direct.fat32Calls) / direct.columns,
+                double(direct.fat32Bytes) / direct.columns, unsigned(direct.blocksRead),
+                double(windowed.fat32Calls) / windowed.columns, double(windowed.fat32Bytes) / windowed.columns,
+                unsigned(windowed.blocksRead));
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+    CHECK(fs.init());
+    CHECK(readExpected());
+
+    test_pool_has_fixed_slots();
+    test_column_read_cost();
+
+    disk_image_close();
+    CHECK_DONE();
+}
@@ -0,0 +1,316 @@
+// Game on the "band" levels (authored obstacles, with the three rows around the portal row
+// left free so a ship holding its row flies the whole level), raw or compressed: what the
+// game holds for each column against a straight read of the level file.
+//
+// usage: test_game <disk.img>     (band.img or band_v2.img; L03 is the wide one)
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+#include "app/Config.hpp"
+#include "check.h"
+#include "game/Game.hpp"
+#include "game/LevelSource.hpp"
+#include "host_platform.hpp"
+
+using namespace gv;
+using namespace gv::test;
+
+static const char* const kLevels[] = { "levels/L01.BIN", "levels/L02.BIN", "levels/L03.BIN" };
+constexpr int kMaxWidth = kMaxLevelWidth;
+
+static PicoFileSystem fs;
+static Game game; // carries the column cache; too big for the stack
+static Column56 fileCols[kMaxWidth];
+static int fileWidth = 0;
+
+// Every column of the level in one sequential read, outside the game's streaming
+static bool readFile(const char* path) {
+    LevelSource src;
+    uint8_t buf[LevelSource::kUnitBytes];
+    fileWidth = 0;
+    if (!src.open(fs, path)) return false;
+    const int width = int(src.header().width);
+    const bool ok = width <= kMaxWidth && src.readColumns(0, width, buf, fileCols);
+    src.close();
+    if (ok) fileWidth = width;
+    return ok;
+}
+
+static bool sameCells(const ColumnCells& a, const ColumnCells& b) {
+    if (a.occupied != b.occupied) return false;
+    for (int r = 0; r < kLevelHeight; ++r) {
+        if (a.shape[r] != b.shape[r] || a.mod[r] != b.mod[r]) return false;
+    }
+    return true;
+}
+
+// One game tick; tapping thrust every other frame holds the ship on its row.
+static void tick(int i) {
+    InputState in;
+    in.thrust = (i & 1) == 0;
+    in.thrustPressed = in.thrust;
+    game.update(in, fx::fromMicros(kFrameUs));
+}
+
+// Visible columns [lo, hi) of the window streamColumns() keeps for the current scroll
+static void visibleSpan(int& lo, int& hi) {
+    lo = game.scrollX().toInt() / kCellSize - kColsPadLeft;
+    if (lo < 0) lo = 0;
+    hi = lo + kColsVisible;
+    if (hi > fileWidth) hi = fileWidth;
+}
+
+// Flying a streamed level end to end, every visible column is in the ring cache every
+// frame and decodes to the file's column, and the card is read on only a few frames: the
+// cache is filled a whole unit ahead, not column by column as each comes into view (user-001)
+static void test_streamed_window_matches_file(const char* path) {
+    CHECK(readFile(path));
+    CHECK(game.loadLevel(path, LevelResidency::Streamed));
+    CHECK(!game.levelResident());
+
+    int frames = 0, bad = 0;
+    uint32_t transfers = 0, worst = 0;
+    for (int i = 0; !game.finishedScroll() && i < 8 * fileWidth; ++i, ++frames) {
+        const uint32_t before = disk_image_counts()->transfers;
+        tick(i);
+        const uint32_t n = disk_image_counts()->transfers - before;
+        transfers += n;
+        if (n > worst) worst = n;
+
+        int lo, hi;
+        visibleSpan(lo, hi);
+        for (int c = lo; c < hi; ++c) {
+            const ColumnCells* col = game.cachedColumn((uint16_t)c);
+            if (!col || !sameCells(*col, ColumnCells::decode(fileCols[c]))) ++bad;
+        }
+    }
+    CHECK_EQ(bad, 0);
+    CHECK(game.finishedScroll());
+    CHECK(game.state() == RunState::FinishedFlyOut);
+    CHECK(transfers * 10 < uint32_t(frames));
+    CHECK(worst <= 2);
+    std::printf("%s streamed: %d frames, %d columns, %u transfers (%.3f per frame, worst frame %u)\n",
+                path, frames, fileWidth, unsigned(transfers), double(transfers) / frames, unsigned(worst));
+    game.unloadLevel();
+}
+
+// I/O of one run: loading, then flying the level end to end
+struct RunIo {
+    uint32_t loadTransfers = 0;
+    uint64_t loadUs = 0;
+    uint32_t flightTransfers = 0;
+    uint32_t worstFrameTransfers = 0;
+    int frames = 0;
+    int bad = 0; // visible columns missing or not the file's
+};
+
+static RunIo flyLevel(const char* path, LevelResidency policy) {
+    RunIo io;
+    disk_image_reset_counts();
+    const uint64_t t0 = cardUs();
+    CHECK(game.loadLevel(path, policy));
+    io.loadTransfers = disk_image_counts()->transfers;
+    io.loadUs = cardUs() - t0;
+
+    for (int i = 0; !game.finishedScroll() && i < 8 * fileWidth; ++i, ++io.frames) {
+        const uint32_t before = disk_image_counts()->transfers;
+        tick(i);
+        const uint32_t n = disk_image_counts()->transfers - before;
+        io.flightTransfers += n;
+        if (n > io.worstFrameTransfers) io.worstFrameTransfers = n;
+
+        int lo, hi;
+        visibleSpan(lo, hi);
+        for (int c = lo; c < hi; ++c) {
+            const ColumnCells* col = game.cachedColumn((uint16_t)c);
+            if (!col || !sameCells(*col, ColumnCells::decode(fileCols[c]))) ++io.bad;
+        }
+    }
+    CHECK(game.state() == RunState::FinishedFlyOut);
+    return io;
+}
+
+// A resident level is read whole at load and nothing touches the card while it is flown;
+// every visible column still matches the file (user-009)
+static void test_resident_level_reads_nothing_in_flight(const char* path) {
+    static Column56 arena[kMaxWidth];
+    CHECK(readFile(path));
+    game.setLevelArena(arena, sizeof(arena));
+
+    const RunIo resident = flyLevel(path, LevelResidency::Resident);
+    CHECK(game.levelResident());
+    CHECK_EQ(resident.flightTransfers, 0);
+    CHECK_EQ(resident.bad, 0);
+    game.unloadLevel();
+
+    const RunIo streamed = flyLevel(path, LevelResidency::Streamed);
+    CHECK(!game.levelResident());
+    CHECK_EQ(streamed.bad, 0);
+    game.unloadLevel();
+
+    // Too small an arena: the level streams instead
+    game.setLevelArena(arena, size_t(fileWidth - 1) * kColumnBytes);
+    CHECK(game.loadLevel(path, LevelResidency::Resident));
+    CHECK(!game.levelResident());
+    game.unloadLevel();
+    game.setLevelArena(nullptr, 0);
+
+    std::printf("%s resident: load %u transfers %.2f ms, flight %u transfers; "
+                "streamed: load %u transfers %.2f ms, flight %u transfers over %d frames (worst frame %u)\n",
+                path, unsigned(resident.loadTransfers), resident.loadUs / 1000.0, unsigned(resident.flightTransfers),
+                unsigned(streamed.loadTransfers), streamed.loadUs / 1000.0, unsigned(streamed.flightTransfers),
+                streamed.frames, unsigned(streamed.worstFrameTransfers));
+}
+
+static uint32_t fileBytes(const char* path) {
+    fat32_file_t f;
+    if (fat32_open(&f, path) != FAT32_OK) return 0;
+    const uint32_t size = fat32_size(&f);
+    fat32_close(&f);
+    return size;
+}
+
+// Streaming a level longer than the read-ahead window, the card is read about once per window of file:
+// finding a block costs no read of its own, so fetches keep landing in the window (user-008)
+static void test_streamed_level_reads_by_window(const char* path) {
+    const uint32_t bytes = fileBytes(path);
+    CHECK(bytes > kLevelReadAheadBytes);
+    CHECK(readFile(path));
+
+    fat32_reset_cache_stats();
+    const RunIo io = flyLevel(path, LevelResidency::Streamed);
+    fat32_cache_stats_t stats;
+    fat32_get_cache_stats(&stats);
+    CHECK_EQ(io.bad, 0);
+    game.unloadLevel();
+
+    const uint32_t windows = (bytes + kLevelReadAheadBytes - 1) / kLevelReadAheadBytes;
+    CHECK(io.loadTransfers + io.flightTransfers <= 2 * windows + 4);
+    CHECK(io.worstFrameTransfers <= 2);
+    std::printf("%s: %u bytes (%u windows), load %u + flight %u transfers, worst frame %u, "
+                "%u blocks read, %u cache hits\n",
+                path, unsigned(bytes), unsigned(windows), unsigned(io.loadTransfers),
+                unsigned(io.flightTransfers), unsigned(io.worstFrameTransfers),
+                unsigned(stats.blocks_read), unsigned(stats.hits));
+}
+
+// ColumnCells::decode() agrees with the packed Column56 accessors, for every cell value in
+// every row and for each column of the level files (user-002)
+static bool decodesLikePacked(const Column56& c) {
+    const ColumnCells cells = ColumnCells::decode(c);
+    for (int r = 0; r < kLevelHeight; ++r) {
+        const bool occupied = (cells.occupied >> r) & 1u;
+        if (cells.shape[r] != c.shape(r) || cells.mod[r] != c.mod(r)) return false;
+        if (occupied != (c.shape(r) != ShapeId::Empty)) return false;
+    }
+    return (cells.occupied >> kLevelHeight) == 0;
+}
+
+static void test_cells_decode_like_packed() {
+    int bad = 0;
+    for (int r = 0; r < kLevelHeight; ++r) {
+        for (uint64_t cell = 0; cell < 64; ++cell) {
+            // The cell under test, with its neighbours set to something else
+            const uint64_t v = (0x00FFFFFFFFFFFFFFull & ~(0x3Full << (r * 6))) | (cell << (r * 6));
+            Column56 c;
+            for (int i = 0; i < kColumnBytes; ++i) c.b[i] = uint8_t(v >> (8 * i));
+            if (!decodesLikePacked(c)) ++bad;
+        }
+    }
+    for (const char* path : kLevels) {
+        CHECK(readFile(path));
+        for (int c = 0; c < fileWidth; ++c) {
+            if (!decodesLikePacked(fileCols[c])) ++bad;
+        }
+    }
+    CHECK_EQ(bad, 0);
+}
+
+// What a pass over the level's cells costs: Column56::shape()/mod() unpacking every row,
+// ColumnCells testing all nine rows, and ColumnCells walking only the occupied rows with
+// countr_zero. All three see the same cells (user-002)
+static void report_cell_access_cost() {
+    static Column56 packed[3 * kMaxWidth];
+    static ColumnCells cells[3 * kMaxWidth];
+    int n = 0;
+    for (const char* path : kLevels) {
+        CHECK(readFile(path));
+        for (int c = 0; c < fileWidth && n < 3 * kMaxWidth; ++c, ++n) {
+            packed[n] = fileCols[c];
+            cells[n] = ColumnCells::decode(fileCols[c]);
+        }
+    }
+
+    auto viaPacked = [&]() {
+        uint32_t sum = 0;
+        for (int i = 0; i < n; ++i) {
+            for (int y = 0; y < kLevelHeight; ++y) {
+                const ShapeId s = packed[i].shape(y);
+                if (s != ShapeId::Empty) sum += uint32_t(s) * 4 + uint32_t(packed[i].mod(y)) + uint32_t(y);
+            }
+        }
+        return sum;
+    };
+    auto viaAllRows = [&]() {
+        uint32_t sum = 0;
+        for (int i = 0; i < n; ++i) {
+            for (int y = 0; y < kLevelHeight; ++y) {
+                const ShapeId s = cells[i].shape[y];
+                if (s != ShapeId::Empty) sum += uint32_t(s) * 4 + uint32_t(cells[i].mod[y]) + uint32_t(y);
+            }
+        }
+        return sum;
+    };
+    auto viaOccupied = [&]() {
+        uint32_t sum = 0;
+        for (int i = 0; i < n; ++i) {
+            for (uint32_t rows = cells[i].occupied; rows; rows &= rows - 1) {
+                const int y = std::countr_zero(rows);
+                sum += uint32_t(cells[i].shape[y]) * 4 + uint32_t(cells[i].mod[y]) + uint32_t(y);
+            }
+        }
+        return sum;
+    };
+
+    long occupied = 0;
+    for (int i = 0; i < n; ++i) occupied += std::popcount(unsigned(cells[i].occupied));
+    const uint32_t want = viaPacked();
+    CHECK_EQ(viaAllRows(), want);
+    CHECK_EQ(viaOccupied(), want);
+
+    constexpr int kRounds = 2000;
+    auto time = [&](auto pass) {
+        volatile uint32_t sink = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < kRounds; ++r) sink = sink + pass();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0);
+        return double(ns.count()) / (double(kRounds) * n);
+    };
+    const double packedNs = time(viaPacked);
+    const double allRowsNs = time(viaAllRows);
+    const double occupiedNs = time(viaOccupied);
+
+    std::printf("cells: %d columns, %.1f%% of cells occupied; per column: shape()/mod() %.2f ns, "
+                "ColumnCells all rows %.2f ns, countr_zero walk %.2f ns\n",
+                n, 100.0 * double(occupied) / (double(n) * kLevelHeight), packedNs, allRowsNs, occupiedNs);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+    CHECK(fs.init());
+    game.setFileSystem(&fs);
+
+    for (const char* path : kLevels) test_streamed_window_matches_file(path);
+    for (const char* path : kLevels) test_resident_level_reads_nothing_in_flight(path);
+    test_streamed_level_reads_by_window("levels/L03.BIN");
+    test_cells_decode_like_packed();
+    report_cell_access_cost();
+
+    disk_image_close();
+    CHECK_DONE();
+}
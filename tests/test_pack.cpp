@@ -0,0 +1,227 @@
+// LevelPack on the fixture image: every packed level against its loose file, what the
+// compressed format costs to decode, and several views over the one pack file.
+//
+// usage: test_pack <disk.img>     (an image with levels/LEVELS.PAK and the loose levels)
+
+#include <chrono>
+#include <cstring>
+
+#include "check.h"
+#include "game/LevelPack.hpp"
+#include "game/LevelSource.hpp"
+#include "platform/pico/PicoFileSystem.hpp"
+#include "disk_image.h"
+
+using namespace gv;
+
+static PicoFileSystem fs;
+static LevelPack pack;
+
+static bool sameColumns(const Column56* a, const Column56* b, int n) {
+    return std::memcmp(a, b, size_t(n) * sizeof(Column56)) == 0;
+}
+
+// Every level in the pack decodes to the columns of the loose file it was built from, and
+// the TOC's header copy is the payload's own (user-011)
+static void test_pack_matches_loose_files() {
+    CHECK(pack.levelCount() >= 2);
+
+    for (int i = 0; i < pack.levelCount(); ++i) {
+        char path[32];
+        std::snprintf(path, sizeof(path), "levels/%s", pack.levelName(i));
+
+        LevelSource packed, loose;
+        CHECK(packed.open(pack, path));
+        CHECK(loose.open(fs, path));
+        if (!packed.isOpen() || !loose.isOpen()) continue;
+
+        const LevelHeaderV1& h = packed.header();
+        const LevelHeaderV1& l = loose.header();
+        CHECK(std::memcmp(&h, &pack.levelHeader(i), sizeof(h)) == 0);
+        CHECK_EQ(h.width, l.width);
+        CHECK_EQ(h.height, l.height);
+        CHECK_EQ(h.startX, l.startX);
+        CHECK_EQ(h.startY, l.startY);
+        CHECK_EQ(h.portalDx, l.portalDx);
+        CHECK_EQ(h.portalY, l.portalY);
+
+        static Column56 a[1024], b[1024];
+        uint8_t buf[LevelSource::kUnitBytes];
+        CHECK(h.width <= 1024);
+        CHECK(packed.readColumns(0, h.width, buf, a));
+        CHECK(loose.readColumns(0, l.width, buf, b));
+        CHECK(sameColumns(a, b, h.width));
+
+        // Unit by unit too, the way streaming fetches them
+        for (int first = 0; first < int(h.width); first += packed.unitCols()) {
+            Column56 cols[kColsPrefetch];
+            CHECK(packed.readUnit(first, buf, cols));
+            CHECK(sameColumns(cols, b + first, packed.unitCount(first)));
+        }
+
+        packed.close();
+        loose.close();
+    }
+}
+
+static size_t readAll(IFile* f, uint8_t* dst, size_t cap) {
+    size_t total = 0, got = 0;
+    while (total < cap && f->read(dst + total, cap - total, got) && got > 0) total += got;
+    return total;
+}
+
+static uint32_t le32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// Each shipped level raw (GVL1, the loose file) and compressed (GVL2, in the pack): block by
+// block from RAM, decode_block_v2() gives the raw file's columns. Prints both sizes and what
+// decoding costs per column against the 7-byte copy of a raw column (user-008)
+static void test_compressed_levels_decode_like_raw() {
+    static uint8_t raw[16384], packed[16384];
+    static Column56 cols[kMaxLevelWidth];
+    constexpr int kRounds = 2000;
+
+    for (int i = 0; i < pack.levelCount(); ++i) {
+        char path[32];
+        std::snprintf(path, sizeof(path), "levels/%s", pack.levelName(i));
+
+        IFile* f = fs.openRead(path);
+        IFile* g = pack.openRead(path);
+        CHECK(f && g);
+        if (!f || !g) continue;
+        const size_t rawBytes = readAll(f, raw, sizeof(raw));
+        const size_t packedBytes = readAll(g, packed, sizeof(packed));
+        f->close();
+        g->close();
+
+        LevelHeaderV1 h;
+        LevelInfoV2 info;
+        std::memcpy(&h, raw, sizeof(h));
+        std::memcpy(&info, packed + sizeof(LevelHeaderV1), sizeof(info));
+        CHECK(std::memcmp(h.magic, "GVL1", 4) == 0);
+        CHECK(std::memcmp(packed, "GVL2", 4) == 0);
+        CHECK(h.width <= kMaxLevelWidth);
+        CHECK_EQ(rawBytes, sizeof(LevelHeaderV1) + size_t(h.width) * kColumnBytes);
+
+        const Column56* dict = reinterpret_cast<const Column56*>(packed + sizeof(LevelHeaderV1) + sizeof(info));
+        const uint8_t* table = packed + sizeof(LevelHeaderV1) + sizeof(info) + size_t(info.dictCount) * kColumnBytes;
+        const int width = int(h.width);
+        const int blockCols = 1 << info.blockShift;
+
+        auto decodeAll = [&]() {
+            bool ok = true;
+            for (int b = 0; b < int(info.blockCount); ++b) {
+                const int first = b * blockCols;
+                const int count = (width - first < blockCols) ? width - first : blockCols;
+                const uint32_t lo = le32(table + 4 * b), hi = le32(table + 4 * (b + 1));
+                ok &= hi >= lo && hi <= packedBytes &&
+                      decode_block_v2(packed + lo, hi - lo, dict, info.dictCount, cols + first, count);
+            }
+            return ok;
+        };
+        std::memset(cols, 0, sizeof(cols));
+        CHECK(decodeAll());
+        CHECK(std::memcmp(cols, raw + sizeof(LevelHeaderV1), size_t(width) * kColumnBytes) == 0);
+
+        // The same columns, block by block, copied from the raw file as a GVL1 fetch does
+        auto copyAll = [&]() {
+            for (int first = 0; first < width; first += blockCols) {
+                const int count = (width - first < blockCols) ? width - first : blockCols;
+                std::memcpy(cols + first, raw + sizeof(LevelHeaderV1) + size_t(first) * kColumnBytes,
+                            size_t(count) * kColumnBytes);
+            }
+        };
+
+        volatile uint8_t sink = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < kRounds; ++r) {
+            sink = sink + uint8_t(decodeAll());
+            sink = sink + cols[r % width].b[0];
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int r = 0; r < kRounds; ++r) {
+            copyAll();
+            sink = sink + cols[r % width].b[0];
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        const double columns = double(kRounds) * width;
+        const double decodeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / columns;
+        const double copyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / columns;
+
+        std::printf("%s: %d columns, GVL1 %zu bytes, GVL2 %zu bytes (%.0f%%, %d dictionary columns); "
+                    "decode_block_v2 %.2f ns per column, raw copy %.2f ns\n",
+                    path, width, rawBytes, packedBytes, 100.0 * double(packedBytes) / double(rawBytes),
+                    int(info.dictCount), decodeNs, copyNs);
+    }
+}
+
+static bool readAt(IFile* f, size_t offset, void* dst, size_t bytes) {
+    size_t got = 0;
+    return f->seek(offset) && f->read(dst, bytes, got) && got == bytes;
+}
+
+// The next-level preload reads one payload while streaming has a read-ahead refill in
+// flight on another: each view's request stays its own (user-016)
+static void test_views_keep_their_own_requests() {
+    CHECK(pack.levelCount() >= 2);
+    const size_t offset = 100;
+
+    uint8_t expect[64], got[64], header[sizeof(LevelHeaderV1)];
+    IFile* a = pack.openLevel(0);
+    IFile* b = pack.openLevel(1);
+    CHECK(a && b);
+    a->hint(AccessPattern::ForwardWindow, FatFile::kWindowBytes);
+    CHECK(readAt(a, offset, expect, sizeof(expect)));
+    a->hint(AccessPattern::ForwardWindow, FatFile::kWindowBytes); // drops the window again
+
+    // a's refill is in flight when b seeks, reads and polls
+    size_t n = 0;
+    CHECK(a->seek(offset));
+    CHECK(a->readAsync(got, sizeof(got), n) == IoStatus::Pending);
+    CHECK(b->poll(n) == IoStatus::Done);
+    CHECK_EQ(n, 0);
+    CHECK(readAt(b, 0, header, sizeof(header)));
+    CHECK(std::memcmp(header, &pack.levelHeader(1), sizeof(header)) == 0);
+
+    // a still gets its own bytes, once, and its position moves past them
+    size_t total = 0;
+    IoStatus st = IoStatus::Pending;
+    while (st == IoStatus::Pending) st = a->poll(n);
+    CHECK(st == IoStatus::Done);
+    total += n;
+    while (total < sizeof(got)) {
+        CHECK(a->readAsync(got + total, sizeof(got) - total, n) == IoStatus::Done);
+        CHECK(n > 0);
+        total += n;
+    }
+    CHECK(std::memcmp(got, expect, sizeof(got)) == 0);
+    CHECK_EQ(a->tell(), offset + sizeof(got));
+    CHECK(a->poll(n) == IoStatus::Done);
+    CHECK_EQ(n, 0);
+
+    // Closing a view with a read in flight leaves the file usable for the other
+    CHECK(a->seek(0));
+    CHECK(a->readAsync(got, sizeof(got), n) != IoStatus::Error);
+    a->close();
+    CHECK(readAt(b, 0, header, sizeof(header)));
+    CHECK(std::memcmp(header, &pack.levelHeader(1), sizeof(header)) == 0);
+    b->close();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+    CHECK(fs.init());
+    CHECK(pack.open(fs, "levels/LEVELS.PAK"));
+
+    test_pack_matches_loose_files();
+    test_compressed_levels_decode_like_raw();
+    test_views_keep_their_own_requests();
+
+    pack.close();
+    disk_image_close();
+    CHECK_DONE();
+}
@@ -0,0 +1,824 @@
+// Renderer on a generated level held in RAM: dense rows of every shape and modifier above
+// and below a free band the ship flies along, so the whole level can be drawn frame by frame.
+// The band levels on the image give line counts for real level layouts.
+//
+// usage: test_render <disk.img>     (band.img)
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "app/Config.hpp"
+#include "check.h"
+#include "game/Game.hpp"
+#include "game/LevelMath.hpp"
+#include "game/Playfield.hpp"
+#include "render/Renderer.hpp"
+#include "render/ShapeTables.hpp"
+#include "platform/pico/PicoFileSystem.hpp"
+#include "disk_image.h"
+
+using namespace gv;
+
+namespace {
+
+constexpr int kScreen = 320;
+constexpr int kWidth = 300;    // columns
+constexpr int kFreeRow = 4;    // rows 3..5 stay empty; the ship starts and stays on row 4
+constexpr uint16_t kGreen = 0x07E0;
+constexpr uint16_t kPurple = 0xF81F;
+
+// ---- the level, as a GVL1 file in RAM ----
+// Every shape with every modifier, with runs of Square cells along the top row and in blocks
+// below the free rows
+uint8_t levelFile[sizeof(LevelHeaderV1) + kWidth * kColumnBytes];
+
+void writeHeader() {
+    LevelHeaderV1 h{};
+    std::memcpy(h.magic, "GVL1", 4);
+    h.version = 1;
+    h.width = kWidth;
+    h.height = kLevelHeight;
+    h.startY = kFreeRow;
+    h.portalDx = -3;
+    h.portalY = kFreeRow;
+    h.endcapW = 6;
+    std::memcpy(levelFile, &h, sizeof(h));
+}
+
+// squares = false leaves Square out, so every green line comes from a table-driven shape
+void buildLevel(bool squares) {
+    writeHeader();
+
+    for (int c = 0; c < kWidth; ++c) {
+        uint64_t v = 0;
+        for (int r = 0; r < kLevelHeight; ++r) {
+            if (r >= kFreeRow - 1 && r <= kFreeRow + 1) continue;
+            const int k = (c * 7 + r * 3) % 20;   // every shape with every modifier, and gaps
+            int shape = k % 5;                     // 0 = empty
+            int mod = k / 5;
+            if (squares && (r == 0 || (c % 23 < 4 && r > kFreeRow + 1))) {
+                shape = int(ShapeId::Square);      // runs along the top, and blocks below the band
+                mod = 0;
+            }
+            if (!squares && shape == int(ShapeId::Square)) shape = int(ShapeId::FullSpike);
+            v |= uint64_t(shape | (mod << 4)) << (r * 6);
+        }
+        for (int i = 0; i < kColumnBytes; ++i) levelFile[sizeof(LevelHeaderV1) + c * kColumnBytes + i] = uint8_t(v >> (8 * i));
+    }
+}
+
+// Nothing but Square cells in row `row`, in columns [col, col + cols)
+void buildSquares(int col, int cols, int row) {
+    writeHeader();
+    std::memset(levelFile + sizeof(LevelHeaderV1), 0, size_t(kWidth) * kColumnBytes);
+    for (int c = col; c < col + cols; ++c) {
+        const uint64_t v = uint64_t(ShapeId::Square) << (row * 6);
+        for (int i = 0; i < kColumnBytes; ++i) levelFile[sizeof(LevelHeaderV1) + c * kColumnBytes + i] |= uint8_t(v >> (8 * i));
+    }
+}
+
+class MemFile final : public IFile {
+public:
+    bool read(void* dst, size_t bytes, size_t& outRead) override {
+        const size_t left = pos_ < sizeof(levelFile) ? sizeof(levelFile) - pos_ : 0;
+        outRead = bytes < left ? bytes : left;
+        std::memcpy(dst, levelFile + pos_, outRead);
+        pos_ += outRead;
+        return true;
+    }
+    bool seek(size_t absOffset) override {
+        pos_ = absOffset;
+        return absOffset <= sizeof(levelFile);
+    }
+    size_t tell() const override { return pos_; }
+    void close() override { pos_ = 0; }
+
+private:
+    size_t pos_ = 0;
+};
+
+class MemFileSystem final : public IFileSystem {
+public:
+    bool init() override { return true; }
+    IFile* openRead(const char*) override { return &file_; }
+
+private:
+    MemFile file_;
+};
+
+MemFileSystem memFs;
+Game game;   // carries the column cache; too big for the stack
+Renderer culled, reference;
+DrawList dlCulled, dlReference;
+
+// One game tick; tapping thrust every other frame holds the ship on its row.
+void tick(int i) {
+    InputState in;
+    in.thrust = (i & 1) == 0;
+    in.thrustPressed = in.thrust;
+    game.update(in, fx::fromMicros(28571));
+}
+
+Camera gameCamera() {
+    Camera cam{};
+    cam.focal = kDefaultFocal;
+    cam.cx = fx::fromInt(kScreen / 2);
+    cam.cy = fx::fromInt(kScreen / 2);
+    cam.pos = Vec3fx{ fx::fromInt(kCamPosX), fx::fromInt(kCamPosY), fx::fromInt(kCamPosZ) };
+    cam.target = Vec3fx{ fx::fromInt(kCamTgtX), fx::fromInt(kCamTgtY), fx::fromInt(kCamTgtZ) };
+    cam.up = Vec3fx{ fx::fromInt(0), fx::fromInt(1), fx::fromInt(0) };
+    return cam;
+}
+
+// ---- level lines (green cells, purple portal) rasterised onto the screen ----
+struct Pixels {
+    uint8_t on[kScreen * kScreen];
+    int count;
+};
+
+Pixels pixCulled, pixReference;
+
+void plot(const Line2D& l, Pixels& out) {
+    // Far off-screen endpoints wrap in int16; those lines are artefacts either way.
+    if (std::abs(l.x0) > 16000 || std::abs(l.y0) > 16000 || std::abs(l.x1) > 16000 || std::abs(l.y1) > 16000) return;
+
+    const int dx = l.x1 - l.x0, dy = l.y1 - l.y0;
+    const int steps = std::max(std::max(std::abs(dx), std::abs(dy)), 1);
+    for (int s = 0; s <= steps; ++s) {
+        const int x = l.x0 + (dx * s + (dx >= 0 ? steps / 2 : -steps / 2)) / steps;
+        const int y = l.y0 + (dy * s + (dy >= 0 ? steps / 2 : -steps / 2)) / steps;
+        if (x < 0 || y < 0 || x >= kScreen || y >= kScreen) continue;
+        if (!out.on[y * kScreen + x]) ++out.count;
+        out.on[y * kScreen + x] = 1;
+    }
+}
+
+void rasterise(const DrawList& dl, Pixels& out) {
+    std::memset(out.on, 0, sizeof(out.on));
+    out.count = 0;
+    for (const Line2D& l : dl.get()) {
+        if (l.color565 == kGreen || l.color565 == kPurple) plot(l, out);
+    }
+}
+
+// Reference pixels with no culled pixel on or next to them (merged boxes and lines cut at
+// other ends can step a pixel apart).
+int missing(const Pixels& got, const Pixels& want) {
+    int n = 0;
+    for (int y = 0; y < kScreen; ++y) {
+        for (int x = 0; x < kScreen; ++x) {
+            if (!want.on[y * kScreen + x]) continue;
+            bool near = false;
+            for (int yy = y - 1; yy <= y + 1 && !near; ++yy)
+                for (int xx = x - 1; xx <= x + 1 && !near; ++xx)
+                    near = xx >= 0 && yy >= 0 && xx < kScreen && yy < kScreen && got.on[yy * kScreen + xx];
+            if (!near) ++n;
+        }
+    }
+    return n;
+}
+
+// Whether every cell corner of the streamed window projects inside int16 range (or lies
+// behind the near plane). Points just in front of the camera plane wrap when cast to
+// screen coordinates and draw artefact lines, culled or not, so such cameras are skipped.
+double real(fx v) { return v.raw() / double(1 << fx::SHIFT); }
+
+bool projectsInRange(const Camera& cam, fx scrollX) {
+    const double px = real(cam.pos.x), py = real(cam.pos.y), pz = real(cam.pos.z);
+    int col0 = scrollX.toInt() / kCellSize - kColsPadLeft;
+    if (col0 < 0) col0 = 0;
+
+    for (int c = col0; c <= col0 + kColsVisible; ++c) {
+        const double x = real(worldXForColumn(c, scrollX)) - px;
+        for (int r = 0; r <= kLevelHeight; ++r) {
+            const double y = real(worldYForRow(r)) - py;
+            for (int z = 0; z <= kCellSize; z += kCellSize) {
+                const double vz = z - pz;
+                const double depth = x * real(cam.fwd.x) + y * real(cam.fwd.y) + vz * real(cam.fwd.z);
+                if (depth <= 0.125) continue;
+                const double sx = x * real(cam.right.x) + y * real(cam.right.y) + vz * real(cam.right.z);
+                const double sy = x * real(cam.up2.x) + y * real(cam.up2.y) + vz * real(cam.up2.z);
+                const double k = real(cam.focal) / depth;
+                if (std::abs(sx * k) > 16000 || std::abs(sy * k) > 16000) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Columns buildScene() draws with culling off: the streamed window
+void drawnColumns(fx scrollX, int& col0, int& col1) {
+    int scrollCol = scrollX.toInt() / kCellSize;
+    if (scrollCol < 0) scrollCol = 0;
+    col0 = scrollCol - kColsPadLeft;
+    if (col0 < 0) col0 = 0;
+    col1 = col0 + kColsVisible;
+    if (col1 > kWidth) col1 = kWidth;
+}
+
+// ---- the per-shape emitters as they stood before the shape tables (user-019) ----
+// Each edge projects both of its ends on its own; modifiers are applied per end with applyMod3()
+fx fi(int v) { return fx::fromInt(v); }
+
+Vec3fx add3(const Vec3fx& a, const Vec3fx& b) { return Vec3fx{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+
+struct BaselineEmitter {
+    const Camera& cam;
+    std::vector<Line2D>& out;
+    long projections = 0;
+
+    void line3(const Vec3fx& A, const Vec3fx& B) {
+        Vec2i a, b;
+        ++projections;
+        if (!projectPoint(cam, A, a)) return;
+        ++projections;
+        if (projectPoint(cam, B, b))
+            out.push_back(Line2D{ int16_t(a.x), int16_t(a.y), int16_t(b.x), int16_t(b.y), kGreen });
+    }
+
+    void edges(const Vec3fx* verts, const int* indices, int count, const Vec3fx& pos,
+               const ModId* mod, const Vec3fx& origin) {
+        for (int i = 0; i < count; i += 2) {
+            Vec3fx vA = add3(pos, verts[indices[i]]);
+            Vec3fx vB = add3(pos, verts[indices[i + 1]]);
+            if (mod) {
+                applyMod3(*mod, origin, vA);
+                applyMod3(*mod, origin, vB);
+            }
+            line3(vA, vB);
+        }
+    }
+
+    void cube(const Vec3fx& pos) {
+        const Vec3fx verts[] = {
+            { fx::zero(),    fx::zero(),    fx::zero()    }, { fi(kCellSize), fx::zero(),    fx::zero()    },
+            { fi(kCellSize), fi(kCellSize), fx::zero()    }, { fx::zero(),    fi(kCellSize), fx::zero()    },
+            { fx::zero(),    fx::zero(),    fi(kCellSize) }, { fi(kCellSize), fx::zero(),    fi(kCellSize) },
+            { fi(kCellSize), fi(kCellSize), fi(kCellSize) }, { fx::zero(),    fi(kCellSize), fi(kCellSize) }
+        };
+        const int indices[] = {
+            0,1, 1,2, 2,3, 3,0,
+            4,5, 5,6, 6,7, 7,4,
+            0,4, 1,5, 2,6, 3,7
+        };
+        edges(verts, indices, 24, pos, nullptr, pos);
+    }
+
+    void squarePyramid(const Vec3fx& pos, ModId mod, fx apexScale, const Vec3fx& origin) {
+        const Vec3fx verts[] = {
+            { fi(kCellSize/2), apexScale*fi(kCellSize), fi(kCellSize/2) }, // apex
+            { fx::zero(),      fx::zero(),              fi(kCellSize)   }, // base corner 0
+            { fi(kCellSize),   fx::zero(),              fi(kCellSize)   }, // base corner 1
+            { fi(kCellSize),   fx::zero(),              fx::zero()      }, // base corner 2
+            { fx::zero(),      fx::zero(),              fx::zero()      }  // base corner 3
+        };
+        const int indices[] = {
+            0,1, 0,2, 0,3, 0,4, // sides
+            1,2, 2,3, 3,4, 4,1  // base
+        };
+        edges(verts, indices, 16, pos, &mod, origin);
+    }
+
+    void rightTriPrism(const Vec3fx& pos, ModId mod, const Vec3fx& origin) {
+        const Vec3fx verts[] = {
+            { fi(kCellSize), fi(kCellSize), fx::zero()    }, // front-right-top
+            { fi(kCellSize), fx::zero(),    fx::zero()    }, // front-right-bottom
+            { fx::zero(),    fx::zero(),    fx::zero()    }, // front-left-bottom
+            { fi(kCellSize), fi(kCellSize), fi(kCellSize) }, // back-right-top
+            { fi(kCellSize), fx::zero(),    fi(kCellSize) }, // back-right-bottom
+            { fx::zero(),    fx::zero(),    fi(kCellSize) }  // back-left-bottom
+        };
+        const int indices[] = {
+            0,1, 1,2, 2,0, // front face
+            3,4, 4,5, 5,3, // back face
+            0,3, 1,4, 2,5  // connecting edges
+        };
+        edges(verts, indices, 18, pos, &mod, origin);
+    }
+
+    void cell(ShapeId sid, ModId mid, fx worldX, fx worldY) {
+        const fx cz = fx::zero();
+        const fx ox = worldX + fi(kCellSize/2);
+        const fx oy = worldY + fi(kCellSize/2);
+        switch (sid) {
+            case ShapeId::Square:    cube({worldX, worldY, cz}); break;
+            case ShapeId::RightTri:  rightTriPrism({worldX, worldY, cz}, mid, {ox, oy, cz}); break;
+            case ShapeId::HalfSpike: squarePyramid({worldX, worldY, cz}, mid, fx::half(), {ox, oy, cz}); break;
+            case ShapeId::FullSpike: squarePyramid({worldX, worldY, cz}, mid, fx::one(), {ox, oy, cz}); break;
+            default: break;
+        }
+    }
+};
+
+} // namespace
+
+// The indexed emitter draws exactly what the per-shape emitters it replaced did (kept above as
+// BaselineEmitter): the same lines in the same order, for every shape and modifier, with a
+// third or so of the projections (user-019)
+static void test_indexed_shapes_match_per_edge() {
+    buildLevel(false);
+    CHECK(game.loadLevel("levels/DENSE.BIN", LevelResidency::Streamed));
+    reference.setCulling(false);
+    reference.setCamera(gameCamera());
+    const Camera& cam = reference.camera();
+
+    std::vector<Line2D> perEdge;
+    long edgeProjections = 0, vertexProjections = 0;
+    int64_t edgeNs = 0, vertexNs = 0;
+    long lines = 0;
+    int frames = 0, mismatched = 0;
+    for (int i = 0; game.state() != RunState::FinishedFlyOut && i < 2000; ++i) {
+        tick(i);
+        if (i % 7 != 0) continue;
+        ++frames;
+
+        dlReference.clear();
+        reference.buildScene(dlReference, game, game.scrollX());
+        std::vector<Line2D> drawn;
+        for (const Line2D& l : dlReference.get())
+            if (l.color565 == kGreen) drawn.push_back(l);
+
+        // The baseline emitters: both ends of each edge projected on their own
+        int col0, col1;
+        drawnColumns(game.scrollX(), col0, col1);
+        perEdge.clear();
+        BaselineEmitter baseline{ cam, perEdge };
+        auto t0 = std::chrono::steady_clock::now();
+        for (int c = col0; c < col1; ++c) {
+            const ColumnCells* col = game.cachedColumn((uint16_t)c);
+            if (!col) continue;
+            for (int r = 0; r < kLevelHeight; ++r)
+                baseline.cell(col->shape[r], col->mod[r], worldXForColumn(c, game.scrollX()), worldYForRow(r));
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        edgeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        edgeProjections += baseline.projections;
+
+        // The same cells, each vertex projected once
+        for (int c = col0; c < col1; ++c) {
+            const ColumnCells* col = game.cachedColumn((uint16_t)c);
+            if (!col) continue;
+            for (int r = 0; r < kLevelHeight; ++r) {
+                if (col->shape[r] == ShapeId::Empty) continue;
+                const ShapeMesh& m = shapeMesh(col->shape[r], col->mod[r]);
+                fx x[kShapeMaxVerts], y[kShapeMaxVerts], z[kShapeMaxVerts];
+                for (int v = 0; v < m.vertCount; ++v) {
+                    x[v] = worldXForColumn(c, game.scrollX()) + fx::fromInt(m.verts[v].x);
+                    y[v] = worldYForRow(r) + fx::fromInt(m.verts[v].y);
+                    z[v] = fx::fromInt(m.verts[v].z);
+                }
+                Vec2i p[kShapeMaxVerts];
+                uint8_t ok[kShapeMaxVerts];
+                projectPoints(cam, x, y, z, p, ok, m.vertCount);
+                vertexProjections += m.vertCount;
+            }
+        }
+        vertexNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t1).count();
+
+        bool same = drawn.size() == perEdge.size();
+        for (size_t k = 0; same && k < drawn.size(); ++k) {
+            same = drawn[k].x0 == perEdge[k].x0 && drawn[k].y0 == perEdge[k].y0 &&
+                   drawn[k].x1 == perEdge[k].x1 && drawn[k].y1 == perEdge[k].y1;
+        }
+        if (!same) ++mismatched;
+        lines += long(drawn.size());
+    }
+    CHECK(game.state() == RunState::FinishedFlyOut);
+    CHECK(frames >= 40);
+    CHECK_EQ(mismatched, 0);
+    CHECK(lines > 0);
+    CHECK(vertexProjections * 5 < edgeProjections * 2);
+    game.unloadLevel();
+
+    std::printf("indexed shapes: %d frames, %ld lines identical; %ld projections per edge end (%.2f ms), "
+                "%ld per vertex (%.2f ms)\n",
+                frames, lines, edgeProjections, edgeNs / 1e6, vertexProjections, vertexNs / 1e6);
+}
+
+// Frustum culling drops nothing that reaches the screen: across a sweep of camera positions,
+// targets and focal lengths over the whole level, every pixel of the unculled scene is drawn
+// by the culled one too (user-024)
+static void test_culling_keeps_everything_visible() {
+    buildLevel(true);
+    reference.setCulling(false);
+    // Merged boxes are cut from the cells each scene draws, so the two scenes can split the
+    // same Squares differently and draw different edges inside them; compare cell by cell.
+    culled.setMergeSquares(false);
+    reference.setMergeSquares(false);
+    CHECK(game.loadLevel("levels/DENSE.BIN", LevelResidency::Streamed));
+
+    static const int kPosX[] = { -60, kCamPosX, 40 };
+    static const int kPosY[] = { -30, kCamPosY, 80 };
+    static const int kPosZ[] = { 40, kCamPosZ, 240 };
+    static const int kTgtX[] = { 0, kCamTgtX, 160 };
+    static const int kFocal[] = { 90, 180, 400 };
+
+    long linesCulled = 0, linesReference = 0;
+    int frames = 0, cameras = 0, skipped = 0, worst = 0;
+    for (int i = 0; game.state() != RunState::FinishedFlyOut && i < 2000; ++i) {
+        tick(i);
+        CHECK(game.state() != RunState::Dead);
+        if (i % 97 != 0) continue;
+        ++frames;
+
+        for (int px : kPosX) for (int py : kPosY) for (int pz : kPosZ) for (int tx : kTgtX) for (int f : kFocal) {
+            Camera cam = gameCamera();
+            cam.pos = Vec3fx{ fx::fromInt(px), fx::fromInt(py), fx::fromInt(pz) };
+            cam.target.x = fx::fromInt(tx);
+            cam.focal = fx::fromInt(f);
+            culled.setCamera(cam);
+            reference.setCamera(cam);
+            if (!projectsInRange(culled.camera(), game.scrollX())) {
+                ++skipped;
+                continue;
+            }
+
+            dlCulled.clear();
+            dlReference.clear();
+            culled.buildScene(dlCulled, game, game.scrollX());
+            reference.buildScene(dlReference, game, game.scrollX());
+            linesCulled += long(dlCulled.get().size());
+            linesReference += long(dlReference.get().size());
+
+            rasterise(dlCulled, pixCulled);
+            rasterise(dlReference, pixReference);
+            const int miss = missing(pixCulled, pixReference);
+            if (miss > worst) worst = miss;
+            CHECK_EQ(miss, 0);
+            ++cameras;
+        }
+    }
+    CHECK(game.state() == RunState::FinishedFlyOut);
+    CHECK(frames >= 10);
+    CHECK(skipped * 4 < cameras);
+    CHECK(linesCulled < linesReference); // culling did drop something
+    game.unloadLevel();
+
+    std::printf("culling: %d scenes checked (%d skipped), %ld of %ld lines kept, worst %d pixels missing\n",
+                cameras, skipped, linesCulled, linesReference, worst);
+}
+
+// Square cells of column c as a row mask, or 0 outside [col0, col1)
+static uint16_t squaresOf(int c, int col0, int col1) {
+    const ColumnCells* col = (c >= col0 && c < col1) ? game.cachedColumn((uint16_t)c) : nullptr;
+    uint16_t rows = 0;
+    for (int r = 0; col && r < kLevelHeight; ++r)
+        if (col->shape[r] == ShapeId::Square) rows |= uint16_t(1u << r);
+    return rows;
+}
+
+// Front and back edges of every Square side with no Square next to it: the outline merged
+// boxes must still draw
+static void exposedSquareEdges(const Camera& cam, fx scrollX, Pixels& out) {
+    std::memset(out.on, 0, sizeof(out.on));
+    out.count = 0;
+    int col0, col1;
+    drawnColumns(scrollX, col0, col1);
+
+    const fx c = fx::fromInt(kCellSize);
+    auto edge = [&](fx x0, fx y0, fx x1, fx y1) {
+        for (fx z : { fx::zero(), c }) {
+            Vec2i a, b;
+            if (projectPoint(cam, { x0, y0, z }, a) && projectPoint(cam, { x1, y1, z }, b))
+                plot(Line2D{ int16_t(a.x), int16_t(a.y), int16_t(b.x), int16_t(b.y), kGreen }, out);
+        }
+    };
+    for (int col = col0; col < col1; ++col) {
+        const uint16_t here = squaresOf(col, col0, col1);
+        const uint16_t left = squaresOf(col - 1, col0, col1), right = squaresOf(col + 1, col0, col1);
+        for (int r = 0; r < kLevelHeight; ++r) {
+            const uint16_t bit = uint16_t(1u << r);
+            if (!(here & bit)) continue;
+            const fx x = worldXForColumn(col, scrollX), y = worldYForRow(r);
+            if (!(left & bit)) edge(x, y, x, y + c);
+            if (!(right & bit)) edge(x + c, y, x + c, y + c);
+            if (!(here & (bit >> 1))) edge(x, y + c, x + c, y + c);           // row 0 is the top
+            if (!(here & uint16_t(bit << 1))) edge(x, y, x + c, y);
+        }
+    }
+}
+
+// Merged Square runs draw only what one cube per cell drew, keep every outer edge, and take
+// fewer lines (user-020)
+static void test_merged_squares_keep_the_outline() {
+    static Renderer merged, unmerged;
+    static Pixels pixMerged, pixUnmerged, pixExposed;
+    buildLevel(true);
+    CHECK(game.loadLevel("levels/DENSE.BIN", LevelResidency::Streamed));
+    merged.setCulling(false);
+    unmerged.setCulling(false);
+    merged.setMergeSquares(true);
+    unmerged.setMergeSquares(false);
+
+    long linesMerged = 0, linesUnmerged = 0;
+    int frames = 0, extra = 0, lost = 0;
+    for (int i = 0; game.state() != RunState::FinishedFlyOut && i < 2000; ++i) {
+        tick(i);
+        if (i % 11 != 0) continue;
+
+        const Camera cam = gameCamera();
+        merged.setCamera(cam);
+        unmerged.setCamera(cam);
+        if (!projectsInRange(merged.camera(), game.scrollX())) continue;
+        ++frames;
+
+        dlCulled.clear();
+        dlReference.clear();
+        merged.buildScene(dlCulled, game, game.scrollX());
+        unmerged.buildScene(dlReference, game, game.scrollX());
+        linesMerged += long(dlCulled.get().size());
+        linesUnmerged += long(dlReference.get().size());
+
+        rasterise(dlCulled, pixMerged);
+        rasterise(dlReference, pixUnmerged);
+        exposedSquareEdges(merged.camera(), game.scrollX(), pixExposed);
+        extra += missing(pixUnmerged, pixMerged);
+        lost += missing(pixMerged, pixExposed);
+    }
+    CHECK(game.state() == RunState::FinishedFlyOut);
+    CHECK(frames >= 10);
+    CHECK_EQ(extra, 0);
+    CHECK_EQ(lost, 0);
+    CHECK(linesMerged < linesUnmerged);
+    game.unloadLevel();
+
+    std::printf("merged squares: %d frames, %ld lines against %ld one cube per cell\n",
+                frames, linesMerged, linesUnmerged);
+}
+
+// Green lines drawn, and lines hidden, for `cols` Squares side by side in row 2 from column 10,
+// seen from above, left and in front of them so each cube turns three faces to the camera
+struct EdgeCount {
+    int drawn = 0;
+    int hidden = 0;
+};
+
+static EdgeCount squareEdges(int cols, bool hiddenEdges) {
+    static Renderer renderer;
+    constexpr int kCol = 10, kRow = 2;
+    buildSquares(kCol, cols, kRow);
+    CHECK(game.loadLevel("levels/SQUARES.BIN", LevelResidency::Streamed));
+
+    const fx x0 = worldXForColumn(kCol, game.scrollX());
+    const fx y0 = worldYForRow(kRow);
+    Camera cam = gameCamera();
+    cam.pos = Vec3fx{ x0 - fx::fromInt(30), y0 + fx::fromInt(40), fx::fromInt(90) };
+    cam.target = Vec3fx{ x0 + fx::fromInt(cols * kCellSize / 2), y0 + fx::fromInt(kCellSize / 2), fx::fromInt(kCellSize / 2) };
+    renderer.setCulling(false);
+    renderer.setMergeSquares(false);
+    renderer.setHiddenEdges(hiddenEdges);
+    renderer.setCamera(cam);
+
+    dlCulled.clear();
+    renderer.buildScene(dlCulled, game, game.scrollX());
+    EdgeCount n;
+    for (const Line2D& l : dlCulled.get())
+        if (l.color565 == kGreen) ++n.drawn;
+    n.hidden = dlCulled.hiddenCount();
+    game.unloadLevel();
+    return n;
+}
+
+// Hidden-edge mode draws a lone cube's three faces toward the camera (9 of its 12 edges),
+// and drops the face of a Square pressed against another; every edge it leaves out is
+// counted, so drawn plus hidden is the full wireframe (user-025)
+static void test_hidden_edges_drop_back_and_shared_faces() {
+    const EdgeCount lone = squareEdges(1, true);
+    const EdgeCount loneFull = squareEdges(1, false);
+    CHECK_EQ(loneFull.drawn, 12);
+    CHECK_EQ(loneFull.hidden, 0);
+    CHECK_EQ(lone.drawn, 9);
+    CHECK_EQ(lone.drawn + lone.hidden, loneFull.drawn);
+
+    // The right cube's left face looks at the camera but lies on the left cube: of its four
+    // edges, the two shared with no other front face go, so 9 + 7 are drawn
+    const EdgeCount pair = squareEdges(2, true);
+    const EdgeCount pairFull = squareEdges(2, false);
+    CHECK_EQ(pairFull.drawn, 24);
+    CHECK_EQ(pair.drawn, 9 + 7);
+    CHECK_EQ(pair.drawn + pair.hidden, pairFull.drawn);
+
+    std::printf("hidden edges: lone cube %d of %d drawn, two Squares %d of %d\n",
+                lone.drawn, loneFull.drawn, pair.drawn, pairFull.drawn);
+}
+
+static bool sameCamera(const Camera& a, const Camera& b) {
+    auto same = [](const Vec3fx& u, const Vec3fx& v) {
+        return u.x.raw() == v.x.raw() && u.y.raw() == v.y.raw() && u.z.raw() == v.z.raw();
+    };
+    return same(a.pos, b.pos) && same(a.target, b.target) && same(a.up, b.up) && same(a.right, b.right) &&
+           same(a.up2, b.up2) && same(a.fwd, b.fwd) && a.focal.raw() == b.focal.raw() &&
+           a.cx.raw() == b.cx.raw() && a.cy.raw() == b.cy.raw();
+}
+
+static bool sameLines(const DrawList& a, const DrawList& b) {
+    if (a.get().size() != b.get().size()) return false;
+    for (size_t i = 0; i < a.get().size(); ++i) {
+        const Line2D& p = a.get()[i];
+        const Line2D& q = b.get()[i];
+        if (p.x0 != q.x0 || p.y0 != q.y0 || p.x1 != q.x1 || p.y1 != q.y1 || p.color565 != q.color565) return false;
+    }
+    return true;
+}
+
+// The follow camera as App::tick() moves it, turned, tilted or zoomed now and then
+static Camera followCamera(int frame) {
+    Camera cam = gameCamera();
+    const fx yOff = game.ship().y * kCameraFollow;
+    cam.pos.y = fx::fromInt(22) + yOff;
+    cam.target.y = yOff;
+    if ((frame / 100) % 4 == 1) cam.target.x = cam.target.x + fx::fromInt(30);
+    if ((frame / 100) % 4 == 2) cam.up = Vec3fx{ fx::fromRatio(1, 10), fx::one(), fx::zero() };
+    if ((frame / 100) % 4 == 3) cam.focal = fx::fromInt(240);
+    return cam;
+}
+
+// Keeping the basis while the camera only translates gives the same camera, and the same
+// scene, as rebuilding it every frame (user-023)
+static void test_translated_camera_matches_rebuild() {
+    static Renderer kept, rebuilt;
+    buildLevel(true);
+    CHECK(game.loadLevel("levels/DENSE.BIN", LevelResidency::Streamed));
+
+    int frames = 0, differs = 0;
+    for (int i = 0; game.state() != RunState::FinishedFlyOut && i < 2000; ++i, ++frames) {
+        tick(i);
+        const Camera cam = followCamera(i);
+        kept.setCamera(cam);
+
+        // Another orientation first, so this one is built from scratch
+        Camera turned = cam;
+        turned.target.z = turned.target.z + fx::one();
+        rebuilt.setCamera(turned);
+        rebuilt.setCamera(cam);
+
+        dlCulled.clear();
+        dlReference.clear();
+        kept.buildScene(dlCulled, game, game.scrollX());
+        rebuilt.buildScene(dlReference, game, game.scrollX());
+        if (!sameCamera(kept.camera(), rebuilt.camera()) || !sameLines(dlCulled, dlReference)) ++differs;
+    }
+    CHECK(game.state() == RunState::FinishedFlyOut);
+    CHECK(frames > 400);
+    CHECK_EQ(differs, 0);
+    game.unloadLevel();
+
+    // setCamera() cost, translating only against turning every call
+    constexpr int kCalls = 200000;
+    Camera cam = gameCamera();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCalls; ++i) {
+        cam.pos.y = fx::fromInt(22) + fx::fromRaw(i);
+        cam.target.y = fx::fromRaw(i);
+        kept.setCamera(cam);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCalls; ++i) {
+        cam.target.z = fx::fromInt(kCamTgtZ) + fx::fromRaw(i & 1);
+        kept.setCamera(cam);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    const double keptNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / kCalls;
+    const double rebuiltNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()) / kCalls;
+
+    std::printf("camera: %d frames identical; setCamera %.0f ns translating, %.0f ns rebuilding the basis\n",
+                frames, keptNs, rebuiltNs);
+}
+
+// projectPoints() over every vertex of the 64 drawn columns gives, point by point, what
+// projectPoint() gives: the same valid flags and the same screen coordinates, for the follow
+// camera turned, tilted and zoomed along the level and for one inside it (user-022)
+static void test_batch_projection_matches_single() {
+    static Renderer renderer;
+    buildLevel(true);
+    CHECK(game.loadLevel("levels/DENSE.BIN", LevelResidency::Streamed));
+
+    std::vector<fx> xs, ys, zs;
+    std::vector<Vec2i> batch, single;
+    std::vector<uint8_t> batchOk, singleOk;
+    long points = 0, behind = 0;
+    int64_t singleNs = 0, batchNs = 0;
+    int frames = 0, mismatched = 0;
+    for (int i = 0; game.state() != RunState::FinishedFlyOut && i < 2000; ++i) {
+        tick(i);
+        if (i % 5 != 0) continue;
+        ++frames;
+
+        int col0, col1;
+        drawnColumns(game.scrollX(), col0, col1);
+        xs.clear();
+        ys.clear();
+        zs.clear();
+        for (int c = col0; c < col1; ++c) {
+            const ColumnCells* col = game.cachedColumn((uint16_t)c);
+            if (!col) continue;
+            for (int r = 0; r < kLevelHeight; ++r) {
+                if (col->shape[r] == ShapeId::Empty) continue;
+                const ShapeMesh& m = (col->shape[r] == ShapeId::Square) ? kBoxMesh : shapeMesh(col->shape[r], col->mod[r]);
+                for (int v = 0; v < m.vertCount; ++v) {
+                    xs.push_back(worldXForColumn(c, game.scrollX()) + fx::fromInt(m.verts[v].x));
+                    ys.push_back(worldYForRow(r) + fx::fromInt(m.verts[v].y));
+                    zs.push_back(fx::fromInt(m.verts[v].z));
+                }
+            }
+        }
+        const int n = int(xs.size());
+        batch.assign(n, Vec2i{});
+        single.assign(n, Vec2i{});
+        batchOk.assign(n, 0);
+        singleOk.assign(n, 0);
+
+        // The follow camera, and one standing in the middle of the drawn columns so part of
+        // the set is behind it
+        Camera inside = followCamera(i);
+        inside.pos.x = worldXForColumn((col0 + col1) / 2, game.scrollX());
+        inside.target.x = inside.pos.x + fx::fromInt(kCellSize);
+        inside.target.z = inside.pos.z;
+        for (const Camera& set : { followCamera(i), inside }) {
+            renderer.setCamera(set);
+            const Camera& cam = renderer.camera();
+
+            auto t0 = std::chrono::steady_clock::now();
+            for (int k = 0; k < n; ++k) singleOk[k] = projectPoint(cam, { xs[k], ys[k], zs[k] }, single[k]) ? 1 : 0;
+            auto t1 = std::chrono::steady_clock::now();
+            projectPoints(cam, xs.data(), ys.data(), zs.data(), batch.data(), batchOk.data(), n);
+            auto t2 = std::chrono::steady_clock::now();
+            singleNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            batchNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+
+            for (int k = 0; k < n; ++k) {
+                if (batchOk[k] != singleOk[k] ||
+                    (singleOk[k] && (batch[k].x != single[k].x || batch[k].y != single[k].y))) {
+                    ++mismatched;
+                }
+                if (!singleOk[k]) ++behind;
+            }
+            points += n;
+        }
+    }
+    CHECK(game.state() == RunState::FinishedFlyOut);
+    CHECK(frames >= 50);
+    CHECK(points > frames * 1000L);
+    CHECK(behind > 0);
+    CHECK_EQ(mismatched, 0);
+    game.unloadLevel();
+
+    std::printf("batch projection: %d frames, %ld points identical (%ld behind the camera); "
+                "projectPoint %.1f ns per point, projectPoints %.1f ns\n",
+                frames, points, behind, double(singleNs) / points, double(batchNs) / points);
+}
+
+// Lines per frame with and without merging, over the band levels flown end to end
+static void report_level_line_counts() {
+    static PicoFileSystem fs;
+    static Renderer merged, unmerged;
+    CHECK(fs.init());
+    game.setFileSystem(&fs);
+    merged.setMergeSquares(true);
+    unmerged.setMergeSquares(false);
+
+    for (const char* path : { "levels/L01.BIN", "levels/L02.BIN" }) {
+        CHECK(game.loadLevel(path, LevelResidency::Streamed));
+        long linesMerged = 0, linesUnmerged = 0;
+        int frames = 0;
+        for (int i = 0; game.state() != RunState::FinishedFlyOut && i < 3000; ++i, ++frames) {
+            tick(i);
+            merged.setCamera(gameCamera());
+            unmerged.setCamera(gameCamera());
+            dlCulled.clear();
+            dlReference.clear();
+            merged.buildScene(dlCulled, game, game.scrollX());
+            unmerged.buildScene(dlReference, game, game.scrollX());
+            linesMerged += long(dlCulled.get().size());
+            linesUnmerged += long(dlReference.get().size());
+        }
+        CHECK(game.state() == RunState::FinishedFlyOut);
+        CHECK(linesMerged < linesUnmerged);
+        std::printf("%s: %.1f lines per frame merged, %.1f one cube per cell\n", path,
+                    double(linesMerged) / frames, double(linesUnmerged) / frames);
+        game.unloadLevel();
+    }
+    game.setFileSystem(&memFs);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || !disk_image_open(argv[1])) {
+        std::fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+    game.setFileSystem(&memFs);
+
+    test_culling_keeps_everything_visible();
+    test_indexed_shapes_match_per_edge();
+    test_merged_squares_keep_the_outline();
+    test_translated_camera_matches_rebuild();
+    test_batch_projection_matches_single();
+    test_hidden_edges_drop_back_and_shared_faces();
+    report_level_line_counts();
+
+    disk_image_close();
+
+    CHECK_DONE();
+}
@@ -0,0 +1,161 @@
+//
+//  sdcard.c and FAT32 on a modelled SD card (sd_card_model.c), checked by the
+//  commands that reach the card
+//
+//  usage: test_sdcard <disk.img>
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+#include "fat32.h"
+#include "sd_card_model.h"
+#include "sdcard.h"
+
+#define FIRST_BLOCK 64 // Somewhere inside the FAT, away from the boot sector
+#define RUN_BLOCKS 32
+
+static FILE *image = NULL;
+static uint8_t expected[RUN_BLOCKS * SD_BLOCK_SIZE];
+static uint8_t buffer[RUN_BLOCKS * SD_BLOCK_SIZE];
+
+// The blocks straight from the image file
+static bool read_image(uint32_t block, uint32_t count, uint8_t *dst)
+{
+    return fseek(image, (long)block * SD_BLOCK_SIZE, SEEK_SET) == 0 &&
+           fread(dst, SD_BLOCK_SIZE, count, image) == count;
+}
+
+// Content of the generated BIG.BIN (mkimage.py pattern_byte)
+static bool matches_pattern(const uint8_t *data, uint32_t offset, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        uint32_t at = offset + (uint32_t)i;
+        if (data[i] != (uint8_t)(at * 7 + (at >> 9)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A single block is one CMD17
+static void test_single_block_read(void)
+{
+    CHECK(read_image(FIRST_BLOCK, 1, expected));
+    sd_card_model_reset_counts();
+
+    CHECK_EQ(sd_read_blocks(FIRST_BLOCK, 1, buffer), SD_OK);
+    const sd_card_model_counts_t *counts = sd_card_model_counts();
+    CHECK_EQ(counts->cmd17, 1);
+    CHECK_EQ(counts->cmd18, 0);
+    CHECK_EQ(counts->blocks_read, 1);
+    CHECK(memcmp(buffer, expected, SD_BLOCK_SIZE) == 0);
+}
+
+// A run is one CMD18 stream closed by one CMD12, not a CMD17 per block (user-005)
+static void test_multi_block_read_streams(void)
+{
+    CHECK(read_image(FIRST_BLOCK, RUN_BLOCKS, expected));
+    sd_card_model_reset_counts();
+
+    memset(buffer, 0, sizeof(buffer));
+    CHECK_EQ(sd_read_blocks(FIRST_BLOCK, RUN_BLOCKS, buffer), SD_OK);
+    const sd_card_model_counts_t *counts = sd_card_model_counts();
+    CHECK_EQ(counts->cmd17, 0);
+    CHECK_EQ(counts->cmd18, 1);
+    CHECK_EQ(counts->cmd12, 1);
+    CHECK_EQ(counts->blocks_read, RUN_BLOCKS);
+    CHECK(memcmp(buffer, expected, sizeof(buffer)) == 0);
+    uint64_t streamed_bytes = counts->spi_bytes;
+
+    // The card is ready for the next command after the stop
+    CHECK_EQ(sd_read_blocks(FIRST_BLOCK, 1, buffer), SD_OK);
+    CHECK(memcmp(buffer, expected, SD_BLOCK_SIZE) == 0);
+
+    // Against the same blocks one command each
+    sd_card_model_reset_counts();
+    for (uint32_t i = 0; i < RUN_BLOCKS; i++)
+    {
+        CHECK_EQ(sd_read_blocks(FIRST_BLOCK + i, 1, buffer + i * SD_BLOCK_SIZE), SD_OK);
+    }
+    CHECK(memcmp(buffer, expected, sizeof(buffer)) == 0);
+    printf("%d blocks: %llu bus bytes streamed, %llu one command each\n", RUN_BLOCKS,
+           (unsigned long long)streamed_bytes, (unsigned long long)counts->spi_bytes);
+    CHECK(streamed_bytes < counts->spi_bytes);
+}
+
+static void on_read_done(sd_error_t result, void *context)
+{
+    *(sd_error_t *)context = result;
+}
+
+// The DMA path streams a run the same way
+static void test_async_multi_block_read_streams(void)
+{
+    CHECK(read_image(FIRST_BLOCK, RUN_BLOCKS, expected));
+    sd_card_model_reset_counts();
+
+    memset(buffer, 0, sizeof(buffer));
+    sd_error_t result = SD_ERROR_READ_FAILED;
+    CHECK_EQ(sd_read_blocks_async(FIRST_BLOCK, RUN_BLOCKS, buffer, on_read_done, &result), SD_OK);
+    CHECK(sd_async_busy());
+    sd_async_wait();
+    CHECK_EQ(result, SD_OK);
+
+    const sd_card_model_counts_t *counts = sd_card_model_counts();
+    CHECK_EQ(counts->cmd17, 0);
+    CHECK_EQ(counts->cmd18, 1);
+    CHECK_EQ(counts->cmd12, 1);
+    CHECK_EQ(counts->blocks_read, RUN_BLOCKS);
+    CHECK(memcmp(buffer, expected, sizeof(buffer)) == 0);
+}
+
+// fat32_read of a contiguous file reaches the card as CMD18 runs (user-005)
+static void test_fat32_read_streams_runs(void)
+{
+    fat32_file_t file;
+    CHECK_EQ(fat32_open(&file, "levels/BIG.BIN"), FAT32_OK);
+
+    sd_card_model_reset_counts();
+    size_t got = 0;
+    CHECK_EQ(fat32_read(&file, buffer, sizeof(buffer), &got), FAT32_OK);
+    CHECK_EQ(got, sizeof(buffer));
+    CHECK(matches_pattern(buffer, 0, got));
+
+    const sd_card_model_counts_t *counts = sd_card_model_counts();
+    printf("fat32_read of %u bytes: %u CMD18, %u CMD17, %u blocks\n", (unsigned)got,
+           (unsigned)counts->cmd18, (unsigned)counts->cmd17, (unsigned)counts->blocks_read);
+    CHECK_EQ(counts->cmd18, 1);
+    CHECK_EQ(counts->cmd12, 1);
+    CHECK_EQ(counts->blocks_read - counts->cmd17, RUN_BLOCKS); // Every data sector in the stream
+    CHECK(counts->cmd17 <= 8);                                  // The FAT sectors mapping the run
+
+    fat32_close(&file);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || !sd_card_model_open(argv[1]) || !(image = fopen(argv[1], "rb")))
+    {
+        fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+    sd_init();
+    CHECK_EQ(sd_card_init(), SD_OK);
+    CHECK(sd_is_sdhc());
+
+    test_single_block_read();
+    test_multi_block_read_streams();
+    test_async_multi_block_read_streams();
+
+    fat32_init(); // On blockdev_sd(), the card above
+    CHECK_EQ(fat32_mount(), FAT32_OK);
+    test_fat32_read_streams_runs();
+
+    fclose(image);
+    sd_card_model_close();
+    CHECK_DONE();
+}
@@ -0,0 +1,421 @@
+//
+//  FAT32 driver on the fixture disk image, checked through its I/O counters
+//
+//  usage: test_storage <disk.img>
+//
+
+#include <string.h>
+
+#include "check.h"
+#include "disk_image.h"
+#include "fat32.h"
+
+#define LEVEL_HEADER_BYTES 16
+#define LEVEL_COLUMN_BYTES 7
+#define CLUSTER_BYTES 512 // mkimage.py's default: one sector per cluster
+
+// Content of the generated BIG.BIN and FRAG.BIN (mkimage.py pattern_byte)
+static uint8_t pattern_byte(uint32_t i)
+{
+    return (uint8_t)(i * 7 + (i >> 9));
+}
+
+static bool matches_pattern(const uint8_t *data, uint32_t offset, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (data[i] != pattern_byte(offset + (uint32_t)i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool read_at(fat32_file_t *file, uint32_t offset, uint8_t *buffer, size_t size)
+{
+    size_t got = 0;
+    return fat32_seek(file, offset) == FAT32_OK && fat32_read(file, buffer, size, &got) == FAT32_OK && got == size;
+}
+
+static uint32_t fat_reads(void)
+{
+    fat32_cache_stats_t stats;
+    fat32_get_cache_stats(&stats);
+    return stats.fat_reads;
+}
+
+static uint32_t sectors_spanned(uint32_t bytes)
+{
+    return (bytes + FAT32_SECTOR_SIZE - 1) / FAT32_SECTOR_SIZE;
+}
+
+// Read a level the way GVL1 streaming does: the header, then one column at a time
+static uint32_t read_by_columns(fat32_file_t *file)
+{
+    uint8_t buffer[LEVEL_HEADER_BYTES];
+    size_t got = 0;
+    uint32_t total = 0;
+
+    CHECK_EQ(fat32_read(file, buffer, LEVEL_HEADER_BYTES, &got), FAT32_OK);
+    total += got;
+    do
+    {
+        CHECK_EQ(fat32_read(file, buffer, LEVEL_COLUMN_BYTES, &got), FAT32_OK);
+        total += got;
+    } while (got > 0);
+    return total;
+}
+
+// fat32_cache_stats_t against what the device actually served (user-013)
+static void test_counters_match_the_device(void)
+{
+    fat32_file_t file;
+    CHECK_EQ(fat32_open(&file, "levels/L01.BIN"), FAT32_OK);
+
+    fat32_cache_stats_t stats;
+    fat32_reset_cache_stats();
+    disk_image_reset_counts();
+
+    CHECK_EQ(read_by_columns(&file), file.file_size);
+
+    fat32_get_cache_stats(&stats);
+    CHECK_EQ(stats.bytes_read, file.file_size);
+    CHECK_EQ(stats.blocks_read, disk_image_counts()->blocks_read);
+    CHECK_EQ(stats.blocks_written, 0);
+
+    // Column reads are smaller than a sector, so each miss is one single-block transfer,
+    // each data sector misses once and every column read makes at least one lookup.
+    CHECK_EQ(stats.misses, disk_image_counts()->transfers);
+    CHECK_EQ(stats.misses, stats.blocks_read);
+    CHECK(stats.misses >= sectors_spanned(file.file_size));
+    CHECK(stats.hits + stats.misses >= file.file_size / LEVEL_COLUMN_BYTES);
+
+    // The file fits the sector cache: a second pass never reaches the card
+    fat32_reset_cache_stats();
+    disk_image_reset_counts();
+    CHECK_EQ(fat32_seek(&file, 0), FAT32_OK);
+    CHECK_EQ(read_by_columns(&file), file.file_size);
+
+    fat32_get_cache_stats(&stats);
+    CHECK_EQ(stats.blocks_read, 0);
+    CHECK_EQ(stats.misses, 0);
+    CHECK_EQ(disk_image_counts()->transfers, 0);
+    CHECK_EQ(stats.bytes_read, file.file_size);
+
+    fat32_close(&file);
+}
+
+// Opening costs the same for any file size, and a file follows its cluster chain at most
+// once: the contiguous prefix is arithmetic and other seeks resume from the last position
+// resolved (user-003)
+static void test_chain_is_walked_once(void)
+{
+    uint8_t buffer[100];
+    fat32_file_t file;
+
+    fat32_reset_cache_stats();
+    CHECK_EQ(fat32_open(&file, "levels/BIG.BIN"), FAT32_OK);
+    CHECK_EQ(fat_reads(), 0);
+    uint32_t clusters = file.file_size / CLUSTER_BYTES;
+
+    // Contiguous: the first access past cluster 0 maps the run with one entry per cluster,
+    // after that seeks anywhere in the file read no FAT at all
+    CHECK(read_at(&file, file.file_size - sizeof(buffer), buffer, sizeof(buffer)));
+    CHECK(matches_pattern(buffer, file.file_size - sizeof(buffer), sizeof(buffer)));
+    CHECK(fat_reads() <= clusters);
+
+    fat32_reset_cache_stats();
+    for (uint32_t offset = 7; offset < file.file_size - sizeof(buffer); offset += 12345)
+    {
+        CHECK(read_at(&file, offset, buffer, sizeof(buffer)));
+        CHECK(matches_pattern(buffer, offset, sizeof(buffer)));
+    }
+    CHECK_EQ(fat_reads(), 0);
+    fat32_close(&file);
+
+    // Fragmented: reading front to back looks up each link of the chain once, instead of
+    // walking from the first cluster at every cluster boundary
+    CHECK_EQ(fat32_open(&file, "levels/FRAG.BIN"), FAT32_OK);
+    clusters = file.file_size / CLUSTER_BYTES;
+    fat32_reset_cache_stats();
+    for (uint32_t offset = 0; offset < file.file_size; offset += sizeof(buffer))
+    {
+        size_t size = file.file_size - offset < sizeof(buffer) ? file.file_size - offset : sizeof(buffer);
+        CHECK(read_at(&file, offset, buffer, size));
+        CHECK(matches_pattern(buffer, offset, size));
+    }
+    CHECK(fat_reads() <= clusters + 1);
+
+    // A seek back walks forward from the end of the contiguous prefix, not from every hint
+    fat32_reset_cache_stats();
+    CHECK(read_at(&file, 10 * CLUSTER_BYTES, buffer, sizeof(buffer)));
+    CHECK(matches_pattern(buffer, 10 * CLUSTER_BYTES, sizeof(buffer)));
+    CHECK(fat_reads() <= 10);
+    fat32_close(&file);
+}
+
+// A handle from before a card swap stays dead until fat32_reopen, which keeps its
+// position; the retarget layer in clib.c relies on this for newlib streams (user-018)
+static void test_reopen_after_card_swap(void)
+{
+    uint8_t buffer[100];
+    fat32_file_t file;
+    size_t got = 0;
+
+    CHECK_EQ(fat32_open(&file, "levels/BIG.BIN"), FAT32_OK);
+    CHECK(read_at(&file, 3000, buffer, sizeof(buffer)));
+
+    disk_image_set_present(false);
+    CHECK_EQ(fat32_read(&file, buffer, sizeof(buffer), &got), FAT32_ERROR_NO_CARD);
+    CHECK(!fat32_is_mounted());
+    CHECK_EQ(fat32_reopen(&file), FAT32_ERROR_NO_CARD);
+
+    // Back in: the old handle does not remount on its own
+    disk_image_set_present(true);
+    CHECK_EQ(fat32_read(&file, buffer, sizeof(buffer), &got), FAT32_ERROR_NO_CARD);
+    CHECK(!fat32_is_mounted());
+
+    CHECK_EQ(fat32_reopen(&file), FAT32_OK);
+    CHECK(fat32_is_mounted());
+    CHECK_EQ(fat32_read(&file, buffer, sizeof(buffer), &got), FAT32_OK);
+    CHECK_EQ(got, sizeof(buffer));
+    CHECK(matches_pattern(buffer, 3000 + sizeof(buffer), sizeof(buffer)));
+    CHECK(read_at(&file, file.file_size - sizeof(buffer), buffer, sizeof(buffer)));
+    CHECK(matches_pattern(buffer, file.file_size - sizeof(buffer), sizeof(buffer)));
+
+    // A handle whose directory entry no longer matches is not taken back
+    fat32_file_t other = file;
+    other.file_size -= 1;
+    disk_image_set_present(false);
+    fat32_check_card();
+    disk_image_set_present(true);
+    CHECK_EQ(fat32_read(&other, buffer, sizeof(buffer), &got), FAT32_ERROR_NO_CARD);
+    CHECK_EQ(fat32_reopen(&other), FAT32_ERROR_FILE_NOT_FOUND);
+    CHECK_EQ(fat32_reopen(&file), FAT32_OK);
+    fat32_close(&file);
+}
+
+static void cache_counts(uint32_t *hits, uint32_t *misses)
+{
+    fat32_cache_stats_t stats;
+    fat32_get_cache_stats(&stats);
+    *hits = stats.hits;
+    *misses = stats.misses;
+}
+
+// Partial-sector reads go through the sector cache: FAT32_CACHE_SECTORS lines, least
+// recently used out first (user-004)
+static void test_sector_cache_is_lru(void)
+{
+    uint8_t buffer[10];
+    fat32_file_t file;
+    uint32_t hits, misses;
+
+    // Map the contiguous run first, so the reads below touch data sectors only
+    CHECK_EQ(fat32_open(&file, "levels/BIG.BIN"), FAT32_OK);
+    CHECK(read_at(&file, file.file_size - sizeof(buffer), buffer, sizeof(buffer)));
+
+#define SECTOR(n) ((100 + (n)) * FAT32_SECTOR_SIZE + 3)
+    fat32_reset_cache_stats();
+    for (uint32_t i = 0; i < FAT32_CACHE_SECTORS; i++)
+    {
+        CHECK(read_at(&file, SECTOR(i), buffer, sizeof(buffer)));
+        CHECK(matches_pattern(buffer, SECTOR(i), sizeof(buffer)));
+    }
+    cache_counts(&hits, &misses);
+    CHECK_EQ(hits, 0);
+    CHECK_EQ(misses, FAT32_CACHE_SECTORS);
+
+    // All of them fit
+    fat32_reset_cache_stats();
+    for (uint32_t i = 0; i < FAT32_CACHE_SECTORS; i++)
+    {
+        CHECK(read_at(&file, SECTOR(i), buffer, sizeof(buffer)));
+    }
+    cache_counts(&hits, &misses);
+    CHECK_EQ(hits, FAT32_CACHE_SECTORS);
+    CHECK_EQ(misses, 0);
+
+    // Sector 0 was used last of all, so a new sector evicts sector 1 instead
+    CHECK(read_at(&file, SECTOR(0), buffer, sizeof(buffer)));
+    fat32_reset_cache_stats();
+    CHECK(read_at(&file, SECTOR(FAT32_CACHE_SECTORS), buffer, sizeof(buffer)));
+    CHECK(matches_pattern(buffer, SECTOR(FAT32_CACHE_SECTORS), sizeof(buffer)));
+    CHECK(read_at(&file, SECTOR(0), buffer, sizeof(buffer)));
+    cache_counts(&hits, &misses);
+    CHECK_EQ(hits, 1);
+    CHECK_EQ(misses, 1);
+    CHECK(read_at(&file, SECTOR(1), buffer, sizeof(buffer)));
+    CHECK(matches_pattern(buffer, SECTOR(1), sizeof(buffer)));
+    cache_counts(&hits, &misses);
+    CHECK_EQ(misses, 2);
+#undef SECTOR
+
+    fat32_close(&file);
+}
+
+// Opening the same path again resolves it from the path cache: no directory scan, not even
+// a sector cache lookup (user-010)
+static void test_repeated_open_reads_no_sectors(void)
+{
+    fat32_file_t file;
+    fat32_cache_stats_t stats;
+
+    fat32_reset_cache_stats();
+    CHECK_EQ(fat32_open(&file, "levels/L02.BIN"), FAT32_OK);
+    fat32_close(&file);
+    fat32_get_cache_stats(&stats);
+    CHECK_EQ(stats.path_misses, 1);
+    CHECK(stats.hits + stats.misses > 0);
+
+    for (int i = 0; i < 10; i++)
+    {
+        fat32_reset_cache_stats();
+        CHECK_EQ(fat32_open(&file, "levels/L02.BIN"), FAT32_OK);
+        CHECK_EQ(file.file_size, 2312);
+        fat32_close(&file);
+        fat32_get_cache_stats(&stats);
+        CHECK_EQ(stats.path_hits, 1);
+        CHECK_EQ(stats.path_misses, 0);
+        CHECK_EQ(stats.hits + stats.misses, 0);
+        CHECK_EQ(stats.blocks_read, 0);
+    }
+
+    // A path it has not seen still scans
+    fat32_reset_cache_stats();
+    CHECK_EQ(fat32_open(&file, "levels/FRAG.BIN"), FAT32_OK);
+    fat32_close(&file);
+    fat32_get_cache_stats(&stats);
+    CHECK_EQ(stats.path_misses, 1);
+}
+
+// A read spanning whole sectors of a contiguous file goes straight into the caller's buffer
+// as one multi-block transfer; only a partial head and tail sector pass through the sector
+// cache (user-014)
+static void test_aligned_runs_read_straight_through(void)
+{
+    static uint8_t buffer[64 * 1024];
+    const uint32_t sectors = sizeof(buffer) / FAT32_SECTOR_SIZE;
+    fat32_cache_stats_t stats;
+    fat32_file_t file;
+    CHECK_EQ(fat32_open(&file, "levels/BIG.BIN"), FAT32_OK);
+    CHECK(read_at(&file, file.file_size - 1, buffer, 1)); // Map the run first
+
+    // Aligned: one transfer of exactly the sectors asked for, none through the cache
+    fat32_reset_cache_stats();
+    disk_image_reset_counts();
+    blockdev_latency_reset_stats(disk_image_latency());
+    CHECK(read_at(&file, 0, buffer, sizeof(buffer)));
+    CHECK(matches_pattern(buffer, 0, sizeof(buffer)));
+    fat32_get_cache_stats(&stats);
+    CHECK_EQ(disk_image_counts()->transfers, 1);
+    CHECK_EQ(disk_image_counts()->blocks_read, sectors);
+    CHECK_EQ(stats.hits + stats.misses, 0);
+    uint64_t run_us = disk_image_latency()->stats.elapsed_us;
+
+    // Unaligned: the head and tail sectors are bounced, the whole sectors between still stream
+    const uint32_t offset = 5 * FAT32_SECTOR_SIZE + 100;
+    fat32_reset_cache_stats();
+    disk_image_reset_counts();
+    CHECK(read_at(&file, offset, buffer, sizeof(buffer)));
+    CHECK(matches_pattern(buffer, offset, sizeof(buffer)));
+    fat32_get_cache_stats(&stats);
+    CHECK_EQ(stats.misses, 2);
+    CHECK_EQ(disk_image_counts()->transfers, 3);
+    CHECK_EQ(disk_image_counts()->blocks_read, sectors + 1);
+
+    // The same bytes a sector per call, for comparison
+    disk_image_reset_counts();
+    blockdev_latency_reset_stats(disk_image_latency());
+    CHECK_EQ(fat32_seek(&file, 0), FAT32_OK);
+    for (uint32_t i = 0; i < sectors; i++)
+    {
+        size_t got = 0;
+        CHECK_EQ(fat32_read(&file, buffer + i * FAT32_SECTOR_SIZE, FAT32_SECTOR_SIZE, &got), FAT32_OK);
+    }
+    CHECK(matches_pattern(buffer, 0, sizeof(buffer)));
+    CHECK_EQ(disk_image_counts()->transfers, sectors);
+    uint64_t sector_us = disk_image_latency()->stats.elapsed_us;
+    CHECK(run_us < sector_us);
+
+    printf("%u KB aligned: one run %.2f ms (%.2f MB/s), a sector per call %.2f ms\n",
+           (unsigned)(sizeof(buffer) / 1024), run_us / 1000.0, sizeof(buffer) / (double)run_us,
+           sector_us / 1000.0);
+    fat32_close(&file);
+}
+
+// Seek-heavy reads back and forth across a fragmented file; returns the FAT entries looked
+// up and leaves the simulated card time in disk_image_latency()
+static uint32_t read_scattered(fat32_file_t *file)
+{
+    uint8_t buffer[100];
+    fat32_reset_cache_stats();
+    blockdev_latency_reset_stats(disk_image_latency());
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        uint32_t offset = (i * 7919u * CLUSTER_BYTES + i * 37u) % (file->file_size - sizeof(buffer));
+        CHECK(read_at(file, offset, buffer, sizeof(buffer)));
+        CHECK(matches_pattern(buffer, offset, sizeof(buffer)));
+    }
+    return fat_reads();
+}
+
+// A pinned open maps the whole chain once; after that seeks anywhere in a fragmented file
+// look up nothing in the FAT (user-017)
+static void test_pinned_seeks_read_no_fat(void)
+{
+    fat32_file_t file;
+    CHECK_EQ(fat32_open(&file, "levels/FRAG16.BIN"), FAT32_OK);
+    CHECK(!fat32_is_pinned(&file));
+    uint32_t unpinned = read_scattered(&file);
+    uint64_t unpinned_us = disk_image_latency()->stats.elapsed_us;
+    CHECK(unpinned > 0);
+    fat32_close(&file);
+
+    fat32_reset_cache_stats();
+    CHECK_EQ(fat32_open_pinned(&file, "levels/FRAG16.BIN"), FAT32_OK);
+    CHECK(fat32_is_pinned(&file));
+    CHECK(fat_reads() <= file.file_size / CLUSTER_BYTES); // The one walk
+    CHECK_EQ(read_scattered(&file), 0);
+    uint64_t pinned_us = disk_image_latency()->stats.elapsed_us;
+    fat32_close(&file);
+
+    // Closing gives the extents back, so the pool never runs dry
+    for (int i = 0; i < 20; i++)
+    {
+        CHECK_EQ(fat32_open_pinned(&file, "levels/FRAG16.BIN"), FAT32_OK);
+        CHECK(fat32_is_pinned(&file));
+        fat32_close(&file);
+    }
+
+    // More runs than the pool holds: the file still opens, unpinned, and reads correctly
+    CHECK_EQ(fat32_open_pinned(&file, "levels/FRAG.BIN"), FAT32_OK);
+    CHECK(!fat32_is_pinned(&file));
+    read_scattered(&file);
+    fat32_close(&file);
+
+    printf("200 scattered reads of FRAG16.BIN: unpinned %u FAT lookups %.2f ms, pinned none %.2f ms\n",
+           (unsigned)unpinned, unpinned_us / 1000.0, pinned_us / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || !disk_image_open(argv[1]))
+    {
+        fprintf(stderr, "usage: %s <disk.img>\n", argv[0]);
+        return 2;
+    }
+    CHECK_EQ(fat32_mount(), FAT32_OK);
+
+    test_counters_match_the_device();
+    test_chain_is_walked_once();
+    test_reopen_after_card_swap();
+    test_repeated_open_reads_no_sectors();
+    test_sector_cache_is_lru();
+    test_aligned_runs_read_straight_through();
+    test_pinned_seeks_read_no_fat();
+
+    disk_image_close();
+    CHECK_DONE();
+}
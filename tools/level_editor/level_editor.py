@@ -1,12 +1,19 @@
 #!/usr/bin/env python3
 from __future__ import annotations
 
+import argparse
 import json
-import tkinter as tk
-from tkinter import filedialog, messagebox
+import sys
 from dataclasses import dataclass
 from typing import Dict, Optional, Tuple, Any, List, Set
 
+# The editor window needs Tk; --export runs without it (build machines, CI).
+try:
+    import tkinter as tk
+    from tkinter import filedialog, messagebox
+except ImportError:
+    tk = None
+
 # -----------------------------
 # Spec constants
 # -----------------------------
@@ -107,6 +114,12 @@ MOD_ID = {
     "invert": 3,
 }
 
+# --- Binary export (v2, compressed) ---
+GVL2_BLOCK_SHIFT = 4   # 16 columns per block; the runtime accepts blocks up to its fetch unit (16)
+GVL2_MAX_DICT = 63     # dictionary entries (6-bit token index; 63 is the literal escape)
+GVL2_LITERAL = 0x3F    # token index that is followed by a raw 7-byte column
+GVL2_MAX_RUN = 4       # 2-bit run field
+
 # -----------------------------
 # Data model
 # -----------------------------
@@ -255,12 +268,7 @@ class Level:
         last = self.width - 1
         return (last + int(PORTAL_REL["dx"]), int(PORTAL_REL["y"]))
     
-    def write_bin(self, path: str) -> None:
-        # Ensure authored data is clean; export will still include endcap via effective_obstacle_at
-        self.strip_endcap_from_authored()
-
-        magic = b"GVL1"
-        version = 1
+    def header_bytes(self, magic: bytes, version: int) -> bytes:
         width = int(self.width)
         height = int(self.height)  # should be 9
         sx, sy = self.start
@@ -279,30 +287,92 @@ class Level:
         header += bytes([portal_y])
         header += bytes([endcap_w])
         header += b"\x00\x00\x00"  # reserved to 16 bytes
+        return bytes(header)
+
+    def column_words(self) -> List[int]:
+        # One 56-bit word per column: 9 cells x 6 bits, top 2 bits reserved (0)
+        cols = []
+        for x in range(int(self.width)):
+            col = 0
+            for y in range(9):
+                obs = self.effective_obstacle_at(x, y)
+                if obs is None:
+                    shape_id = 0
+                    mod_id = 0
+                else:
+                    shape_id = SHAPE_ID.get(obs.shape, 0) & 0xF
+                    mod_id = MOD_ID.get(obs.mod, 0) & 0x3
+                    # modifiers only meaningful for some shapes; enforce like editor
+                    if obs.shape not in MOD_SHAPES:
+                        mod_id = 0
+
+                cell6 = (shape_id & 0xF) | ((mod_id & 0x3) << 4)
+                col |= (cell6 & 0x3F) << (y * 6)
+            cols.append(col)
+        return cols
+
+    def write_bin(self, path: str) -> None:
+        # Ensure authored data is clean; export will still include endcap via effective_obstacle_at
+        self.strip_endcap_from_authored()
 
         with open(path, "wb") as f:
-            f.write(header)
+            f.write(self.header_bytes(b"GVL1", 1))
 
             # Columns: width * 7 bytes
-            for x in range(width):
-                col = 0
-                for y in range(9):
-                    obs = self.effective_obstacle_at(x, y)
-                    if obs is None:
-                        shape_id = 0
-                        mod_id = 0
-                    else:
-                        shape_id = SHAPE_ID.get(obs.shape, 0) & 0xF
-                        mod_id = MOD_ID.get(obs.mod, 0) & 0x3
-                        # modifiers only meaningful for some shapes; enforce like editor
-                        if obs.shape not in MOD_SHAPES:
-                            mod_id = 0
+            for col in self.column_words():
+                f.write(int(col).to_bytes(7, "little", signed=False))
 
-                    cell6 = (shape_id & 0xF) | ((mod_id & 0x3) << 4)
-                    col |= (cell6 & 0x3F) << (y * 6)
+    def write_bin_v2(self, path: str) -> None:
+        # GVL2: same header, then a column dictionary and RLE-coded blocks behind an offset table
+        self.strip_endcap_from_authored()
+        cols = self.column_words()
+
+        # Dictionary: repeated columns, most frequent first (ties keep first appearance)
+        first_seen: Dict[int, int] = {}
+        counts: Dict[int, int] = {}
+        for i, c in enumerate(cols):
+            first_seen.setdefault(c, i)
+            counts[c] = counts.get(c, 0) + 1
+        ranked = sorted(counts, key=lambda c: (-counts[c], first_seen[c]))
+        dictionary = [c for c in ranked if counts[c] > 1][:GVL2_MAX_DICT]
+        index = {c: i for i, c in enumerate(dictionary)}
+
+        # Blocks: one byte per token, (run - 1) << 6 | index; index 0x3F is followed by a raw column
+        block_cols = 1 << GVL2_BLOCK_SHIFT
+        blocks = []
+        for b0 in range(0, len(cols), block_cols):
+            chunk = cols[b0:b0 + block_cols]
+            data = bytearray()
+            i = 0
+            while i < len(chunk):
+                run = 1
+                while run < GVL2_MAX_RUN and i + run < len(chunk) and chunk[i + run] == chunk[i]:
+                    run += 1
+                c = chunk[i]
+                token = (run - 1) << 6
+                if c in index:
+                    data += bytes([token | index[c]])
+                else:
+                    data += bytes([token | GVL2_LITERAL]) + int(c).to_bytes(7, "little", signed=False)
+                i += run
+            blocks.append(bytes(data))
+
+        info = bytes([GVL2_BLOCK_SHIFT, len(dictionary)]) + len(blocks).to_bytes(2, "little", signed=False)
+        offset = 16 + len(info) + 7 * len(dictionary) + 4 * (len(blocks) + 1)
+        table = bytearray()
+        for data in blocks:
+            table += offset.to_bytes(4, "little", signed=False)
+            offset += len(data)
+        table += offset.to_bytes(4, "little", signed=False)
 
-                # top 2 bits reserved (0)
-                f.write(int(col).to_bytes(7, "little", signed=False))
+        with open(path, "wb") as f:
+            f.write(self.header_bytes(b"GVL2", 2))
+            f.write(info)
+            for c in dictionary:
+                f.write(int(c).to_bytes(7, "little", signed=False))
+            f.write(table)
+            for data in blocks:
+                f.write(data)
 
     def to_json_obj(self) -> Dict[str, Any]:
         # authored obstacles (without endcap)
@@ -433,6 +503,7 @@ class EditorApp:
         tk.Button(left, text="Import JSON…", command=self.import_json).pack(fill="x", pady=2)
         tk.Button(left, text="Export JSON…", command=self.export_json).pack(fill="x", pady=2)
         tk.Button(left, text="Export BIN…", command=self.export_bin).pack(fill="x", pady=2)
+        tk.Button(left, text="Export BIN (GVL2)…", command=self.export_bin_v2).pack(fill="x", pady=2)
 
         tk.Label(left, text="").pack(pady=6)
 
@@ -1049,6 +1120,20 @@ class EditorApp:
         except Exception as ex:
             messagebox.showerror("Export failed", str(ex))
 
+    def export_bin_v2(self) -> None:
+        path = filedialog.asksaveasfilename(
+            title="Export Compressed Level Binary",
+            defaultextension=".bin",
+            filetypes=[("Binary files", "*.bin"), ("All files", "*.*")]
+        )
+        if not path:
+            return
+        try:
+            self.level.write_bin_v2(path)
+            messagebox.showinfo("Export", f"Saved:\n{path}")
+        except Exception as ex:
+            messagebox.showerror("Export failed", str(ex))
+
     def export_json(self) -> None:
         path = filedialog.asksaveasfilename(
             title="Export Level JSON",
@@ -1099,11 +1184,37 @@ class EditorApp:
 # Main
 # -----------------------------
 
-def main() -> None:
+def export(src: str, dst: str, gvl2: bool) -> None:
+    with open(src, "r", encoding="utf-8") as f:
+        lvl = Level.from_json_obj(json.load(f))
+    if gvl2:
+        lvl.write_bin_v2(dst)
+    else:
+        lvl.write_bin(dst)
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="GV3D level editor")
+    ap.add_argument("--export", nargs=2, metavar=("JSON", "BIN"),
+                    help="write the runtime binary for a level and exit, without opening the editor")
+    ap.add_argument("--gvl2", action="store_true", help="with --export: write the compressed GVL2 form")
+    args = ap.parse_args()
+
+    if args.export:
+        try:
+            export(args.export[0], args.export[1], args.gvl2)
+        except (OSError, ValueError) as e:
+            print(f"level_editor: {e}", file=sys.stderr)
+            return 1
+        return 0
+
+    if tk is None:
+        print("level_editor: tkinter is not available; only --export works", file=sys.stderr)
+        return 1
     root = tk.Tk()
     EditorApp(root)
     root.minsize(980, 360)
     root.mainloop()
+    return 0
 
 if __name__ == "__main__":
-    main()
\ No newline at end of file
+    sys.exit(main())
\ No newline at end of file
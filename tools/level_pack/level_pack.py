@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Bundle runtime level binaries (GVL1/GVL2) into one GVPK pack file."""
+from __future__ import annotations
+
+import argparse
+import os
+import struct
+import sys
+from typing import List, Tuple
+
+# -----------------------------
+# Spec constants (match src/game/LevelPack.hpp)
+# -----------------------------
+PACK_MAGIC = b"GVPK"
+PACK_VERSION = 1
+PACK_HEADER_BYTES = 16
+PACK_ENTRY_BYTES = 36
+PACK_NAME_BYTES = 12          # NUL-padded, so names are at most 11 chars
+PACK_MAX_LEVELS = 32          # LevelPack::kMaxLevels
+
+LEVEL_HEADER_BYTES = 16
+LEVEL_MAGICS = {b"GVL1": 1, b"GVL2": 2}
+
+
+def load_level(path: str) -> Tuple[str, bytes]:
+    name = os.path.basename(path).upper()
+    if len(name) >= PACK_NAME_BYTES:
+        raise ValueError(f"{path}: name '{name}' is longer than {PACK_NAME_BYTES - 1} chars")
+
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if len(data) < LEVEL_HEADER_BYTES:
+        raise ValueError(f"{path}: too short for a level header")
+    magic, version = data[0:4], data[4]
+    if LEVEL_MAGICS.get(magic) != version:
+        raise ValueError(f"{path}: not a GVL1/GVL2 level (magic {magic!r}, version {version})")
+
+    return name, data
+
+
+def build_pack(levels: List[Tuple[str, bytes]]) -> bytes:
+    if len(levels) > PACK_MAX_LEVELS:
+        raise ValueError(f"{len(levels)} levels; a pack holds at most {PACK_MAX_LEVELS}")
+
+    names = [n for n, _ in levels]
+    if len(set(names)) != len(names):
+        raise ValueError("duplicate level names")
+
+    header = bytearray(PACK_HEADER_BYTES)
+    header[0:4] = PACK_MAGIC
+    header[4] = PACK_VERSION
+    header[5] = 0
+    struct.pack_into("<HII", header, 6, len(levels), PACK_HEADER_BYTES, 0)
+
+    toc = bytearray()
+    payload = bytearray()
+    offset = PACK_HEADER_BYTES + PACK_ENTRY_BYTES * len(levels)
+    for name, data in levels:
+        entry = bytearray(PACK_ENTRY_BYTES)
+        entry[0:len(name)] = name.encode("ascii")
+        struct.pack_into("<II", entry, PACK_NAME_BYTES, offset + len(payload), len(data))
+        entry[20:36] = data[0:LEVEL_HEADER_BYTES]
+        toc += entry
+        payload += data
+
+    return bytes(header + toc + payload)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("-o", "--output", default="LEVELS.PAK", help="pack file to write")
+    ap.add_argument("levels", nargs="+", help="level .BIN files, in play order")
+    args = ap.parse_args()
+
+    try:
+        levels = [load_level(p) for p in args.levels]
+        pack = build_pack(levels)
+    except (OSError, ValueError) as e:
+        print(f"level_pack: {e}", file=sys.stderr)
+        return 1
+
+    with open(args.output, "wb") as f:
+        f.write(pack)
+
+    for name, data in levels:
+        print(f"  {name:<11} {data[0:4].decode()} {len(data):6d} bytes")
+    print(f"wrote {args.output}: {len(levels)} levels, {len(pack)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())